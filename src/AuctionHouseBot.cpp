@@ -17,6 +17,10 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <chrono>
+#include <functional>
+#include <set>
+
 #include "ObjectMgr.h"
 #include "AuctionHouseMgr.h"
 #include "Config.h"
@@ -24,9 +28,13 @@
 #include "WorldSession.h"
 #include "GameTime.h"
 #include "DatabaseEnv.h"
+#include "StringFormat.h"
 
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotPool.h"
+#include "AuctionHouseBotStats.h"
 
 using namespace std;
 
@@ -39,144 +47,158 @@ AuctionHouseBot::AuctionHouseBot(uint32 account, uint32 id)
     _lastrun_h_sec  = time(NULL);
     _lastrun_n_sec  = time(NULL);
 
+    _backlog_a      = 0;
+    _backlog_h      = 0;
+    _backlog_n      = 0;
+
     _allianceConfig = NULL;
     _hordeConfig    = NULL;
     _neutralConfig  = NULL;
-}
 
-AuctionHouseBot::~AuctionHouseBot()
-{
-    // Nothing
+    _session        = NULL;
+    _AHBplayer      = NULL;
 }
 
-uint32 AuctionHouseBot::getElement(std::set<uint32> set, int index, uint32 botId, uint32 maxDup, AuctionHouseObject* auctionHouse)
+AuctionHouseBot::~AuctionHouseBot()
 {
-    std::set<uint32>::iterator it = set.begin();
-    std::advance(it, index);
+    //
+    // The character goes first, as it refers to the session
+    //
 
-    if (maxDup > 0)
+    if (_AHBplayer)
     {
-        uint32 noStacks = 0;
-
-        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
-        {
-            AuctionEntry* Aentry = itr->second;
-
-            if (Aentry->owner.GetCounter() == botId)
-            {
-                if (*it == Aentry->item_template)
-                {
-                    noStacks++;
-                }
-            }
-        }
-
-        if (noStacks >= maxDup)
-        {
-            return 0;
-        }
+        delete _AHBplayer;
+        _AHBplayer = NULL;
     }
 
-    return *it;
+    if (_session)
+    {
+        delete _session;
+        _session = NULL;
+    }
 }
 
-uint32 AuctionHouseBot::getStackCount(AHBConfig* config, uint32 max)
+uint32 AuctionHouseBot::getNofAuctions(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid)
 {
-    if (max == 1)
+    //
+    // All the auctions
+    //
+
+    if (!config->ConsiderOnlyBotAuctions)
     {
-        return 1;
+        return auctionHouse->Getcount();
     }
 
-    // 
-    // Organize the stacks in a pseudo random way
-    // 
+    //
+    // Just the one handled by the bot, kept updated by the auction house hooks
+    //
 
-    if (config->DivisibleStacks)
-    {
-        uint32 ret = 0;
+    return config->GetBotAuctionCounts(guid.GetCounter());
+}
 
-        if (max % 5 == 0) // 5, 10, 15, 20
-        {
-            ret = urand(1, 4) * 5;
-        }
+// =============================================================================
+// Prepare a request for the planner, following what is left of the quota of each category
+// =============================================================================
 
-        if (max % 4 == 0) // 4, 8, 12, 16
-        {
-            ret = urand(1, 4) * 4;
-        }
+void AuctionHouseBot::fillPlanRequest(AHBConfig* config, AHBPlanRequest& request)
+{
+    request.BotId             = _id;
+    request.AHID              = config->GetAHID();
+    request.Config            = config;
+    request.Count             = 0;
+    request.DivisibleStacks   = config->DivisibleStacks;
+    request.ElapsingTimeClass = config->ElapsingTimeClass;
 
-        if (max % 3 == 0) // 3, 6, 9, 18
-        {
-            ret = urand(1, 3) * 3;
-        }
+    //
+    // A category already full gets no weight, so that no listing is planned for it
+    //
 
-        if (ret > max)
-        {
-            ret = max;
-        }
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        uint32 maximum = config->GetMaximum   (category);
+        uint32 count   = config->GetItemCounts(category);
 
-        return ret;
+        request.Weights[category] = count < maximum ? maximum - count : 0;
     }
 
-    // 
-    // Totally random
-    // 
+    //
+    // Prices and stack limits only depend on the quality: resolve them once for the whole cycle
+    //
 
-    return urand(1, max);
+    for (uint32 quality = 0; quality <= AHB_MAX_QUALITY; ++quality)
+    {
+        request.MinPrices   [quality] = config->GetMinPrice   (quality);
+        request.MaxPrices   [quality] = config->GetMaxPrice   (quality);
+        request.MinBidPrices[quality] = config->GetMinBidPrice(quality);
+        request.MaxBidPrices[quality] = config->GetMaxBidPrice(quality);
+        request.MaxStacks   [quality] = config->GetMaxStack   (quality);
+    }
 }
 
-uint32 AuctionHouseBot::getElapsedTime(uint32 timeClass)
+// =============================================================================
+// This routine plans the listings of a seller cycle, if the auction house needs a refill
+// =============================================================================
+
+void AuctionHouseBot::PlanSell(Player* AHBplayer, AHBConfig* config, uint32 backlog, std::deque<AHBPlannedListing>& plans)
 {
-    switch (timeClass)
+    if (!config->AHBSeller || config->GetMaxItems() == 0)
     {
-    case 2:
-        return urand(1, 5) * 600;   // SHORT = In the range of one hour
+        return;
+    }
 
-    case 1:
-        return urand(1, 23) * 3600; // MEDIUM = In the range of one day
+    if (backlog == 0 && config->IsSellerDormant(_id))
+    {
+        return;
+    }
 
-    default:
-        return urand(1, 3) * 86400; // LONG = More than one day but less than three
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+    if (!auctionHouse)
+    {
+        return;
     }
-}
 
-uint32 AuctionHouseBot::getNofAuctions(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid)
-{
     //
-    // All the auctions
+    // Same limits of the selling cycle
     //
 
-    if (!config->ConsiderOnlyBotAuctions)
+    uint32 auctions = getNofAuctions(config, auctionHouse, AHBplayer->GetGUID());
+
+    if ((auctions >= config->GetMinItems() && backlog == 0) || auctions >= config->GetMaxItems())
     {
-        return auctionHouse->Getcount();
+        return;
     }
 
     //
-    // Just the one handled by the bot
+    // A batch at most, as the seller would plan it, counting the plans left over by the previous cycles
     //
 
-    uint32 count = 0;
+    uint32 wanted = minValue(backlog > 0 ? backlog : config->ItemsPerCycle, config->GetMaxItems() - auctions);
+    wanted = minValue(wanted, AUCTION_HOUSE_BOT_PLAN_BATCH);
 
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+    if (plans.size() >= wanted)
     {
-        AuctionEntry* Aentry = itr->second;
-
-        if (guid == Aentry->owner)
-        {
-            count++;
-            break;
-        }
+        return;
     }
 
-    return count;
+    AHBPlanRequest request;
+    fillPlanRequest(config, request);
+
+    request.Count = wanted - plans.size();
+
+    AHBStopwatch watch(_stats.Get(config->GetAHID(), AHB_PHASE_PLAN));
+
+    AHBPlanner::Plan(request, plans);
 }
 
 // =============================================================================
-// This routine performs the bidding operations for the bot
+// This routine chooses the auctions the bot is going to bid on
 // =============================================================================
 
-void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* session)
+void AuctionHouseBot::ChooseBids(Player* AHBplayer, AHBConfig* config, std::vector<uint32>& picks)
 {
+    picks.clear();
+
     //
     // Check if disabled
     //
@@ -187,72 +209,100 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
     }
 
     //
-    // Retrieve items not owner by the bot and not bought by the bot
+    // If it's not possible to bid stop here
     //
 
-    QueryResult result = CharacterDatabase.Query("SELECT id FROM auctionhouse WHERE itemowner<>{} AND buyguid<>{}", _id, _id);
+    AHBStopwatch watch(_stats.Get(config->GetAHID(), AHB_PHASE_PLAN));
 
-    if (!result)
+    if (config->GetBuyerCandidates().empty())
     {
-        return;
-    }
+        if (config->DebugOutBuyer)
+        {
+            LOG_INFO("module", "AHBot [{}]: no auctions to bid on has been recovered", _id);
+        }
 
-    if (result->GetRowCount() == 0)
-    {
         return;
     }
 
     //
-    // Fetches content of selected AH to look for possible bids
+    // Choose once for all the auctions to bid on: the ones about to expire come first, then either the best
+    // deals or random ones. The buyouts below remove auctions from the candidates, so the choice is made
+    // before any of them happens.
     //
 
-    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
-    std::set<uint32>    possibleBids;
+    std::vector<uint32> others;
+
+    config->SelectBuyerExpiries(config->GetBidsPerInterval(), AHBplayer->GetGUID(), picks);
 
-    do
+    if (picks.size() < config->GetBidsPerInterval())
     {
-        uint32 tmpdata = result->Fetch()->Get<uint32>();
-        possibleBids.insert(tmpdata);
-    } while (result->NextRow());
+        uint32 count = config->GetBidsPerInterval() - picks.size();
 
-    //
-    // If it's not possible to bid stop here
-    //
+        if (config->BuyerBestDeals)
+        {
+            config->SelectBuyerDeals(count, AHBplayer->GetGUID(), others);
+        }
+        else
+        {
+            config->SampleBuyerCandidates(count, AHBplayer->GetGUID(), others);
+        }
 
-    if (possibleBids.empty())
-    {
-        if (config->DebugOutBuyer)
+        std::set<uint32> picked(picks.begin(), picks.end());
+
+        for (uint32 auctionId: others)
         {
-            LOG_INFO("module", "AHBot [{}]: no auctions to bid on has been recovered", _id);
+            if (picked.find(auctionId) == picked.end())
+            {
+                picks.push_back(auctionId);
+            }
         }
+    }
+}
+
+// =============================================================================
+// This routine performs the bidding operations for the bot
+// =============================================================================
 
+void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* session, std::vector<uint32> const& picks)
+{
+    if (picks.empty())
+    {
         return;
     }
 
+    AHBStopwatch watch(_stats.Get(config->GetAHID(), AHB_PHASE_BUY));
+
     //
-    // Perform the operation for a maximum amount of bids attempts configured
+    // Retrieve the auctions of the players, kept updated by the auction house hooks
     //
 
-    for (uint32 count = 1; count <= config->GetBidsPerInterval(); ++count)
-    {
-        //
-        // Choose a random auction from possible auctions
-        //
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+    //
+    // All the bids, buyouts and mails of the interval are saved in a single transaction
+    //
 
-        uint32 randBid = urand(0, possibleBids.size() - 1);
+    auto   trans   = CharacterDatabase.BeginTransaction();
+    uint32 batched = 0;
 
-        std::set<uint32>::iterator it = possibleBids.begin();
-        std::advance(it, randBid);
+    //
+    // Perform the operation for a maximum amount of bids attempts configured
+    //
 
-        AuctionEntry* auction = auctionHouse->GetAuction(*it);
+    for (uint32 auctionId: picks)
+    {
+        AuctionEntry* auction = auctionHouse->GetAuction(auctionId);
+
+        if (!auction)
+        {
+            continue;
+        }
 
         //
-        // Prevent to bid again on the same auction
+        // Do not bid again on the auctions where the bot is already the highest bidder
         //
 
-        possibleBids.erase(randBid);
-
-        if (!auction)
+        if (auction->bidder == AHBplayer->GetGUID())
         {
             continue;
         }
@@ -436,7 +486,7 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
             //
             // Perform a new bid on the auction
             //
-        
+
             if (auction->bidder)
             {
                 if (auction->bidder != AHBplayer->GetGUID())
@@ -444,22 +494,25 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
                     //
                     // Mail to last bidder and return their money
                     //
-        
-                    auto trans = CharacterDatabase.BeginTransaction();
-        
+
                     sAuctionMgr->SendAuctionOutbiddedMail(auction, bidprice, session->GetPlayer(), trans);
-                    CharacterDatabase.CommitTransaction  (trans);
                 }
             }
-        
+
             auction->bidder = AHBplayer->GetGUID();
             auction->bid    = bidprice;
-        
+
             //
             // Save the auction into database
             //
-        
-            CharacterDatabase.Execute("UPDATE auctionhouse SET buyguid = '{}', lastbid = '{}' WHERE id = '{}'", auction->bidder.GetCounter(), auction->bid, auction->Id);
+
+            CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_AUCTION_BID);
+            stmt->SetData(0, auction->bidder.GetCounter());
+            stmt->SetData(1, auction->bid);
+            stmt->SetData(2, auction->Id);
+            trans->Append(stmt);
+
+            config->UpdateBuyerCandidate(auction);
         }
         else
         {
@@ -469,8 +522,6 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
             // Perform the buyout
             //
 
-            auto trans = CharacterDatabase.BeginTransaction();
-
             if ((auction->bidder) && (AHBplayer->GetGUID() != auction->bidder))
             {
                 //
@@ -498,10 +549,12 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
 
             sAuctionMgr->RemoveAItem   (auction->item_guid);
             auctionHouse->RemoveAuction(auction);
-
-            CharacterDatabase.CommitTransaction(trans);
         }
 
+        batched++;
+
+        _stats.Add(config->GetAHID(), bought ? AHB_COUNTER_BUYOUTS : AHB_COUNTER_BIDS, 1);
+
         //
         // Tracing
         //
@@ -518,13 +571,20 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
             }
         }
     }
+
+    if (batched > 0)
+    {
+        AHBStopwatch flush(_stats.Get(config->GetAHID(), AHB_PHASE_FLUSH));
+
+        CharacterDatabase.CommitTransaction(trans);
+    }
 }
 
 // =============================================================================
 // This routine performs the selling operations for the bot
 // =============================================================================
 
-void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
+void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config, uint32& backlog, std::deque<AHBPlannedListing>& plans)
 {
     // 
     // Check if disabled
@@ -532,9 +592,25 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
 
     if (!config->AHBSeller)
     {
+        backlog = 0;
+        plans.clear();
+
         return;
     }
 
+    //
+    // Nothing happened in the market since the auction house was last found satisfied
+    //
+
+    if (backlog == 0 && config->IsSellerDormant(_id))
+    {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    AHBStopwatch watch(_stats.Get(config->GetAHID(), AHB_PHASE_SELL));
+
     // 
     // Check the given limits
     // 
@@ -565,10 +641,19 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         return;
     }
 
-    auctionHouse->Update();
+    //
+    // Have the auction house drop the listings of the bots as soon as they lapse, instead of scanning it at every call
+    //
+
+    time_t now = time(NULL);
+
+    if (config->CountSellerExpiries(now) > 0)
+    {
+        auctionHouse->Update();
+    }
 
     // 
-    // Check if we are clear to proceed
+    // Check if we are clear to proceed; a refill interrupted by the time budget goes on regardless of the minimum
     // 
 
     bool   aboveMin = false;
@@ -576,7 +661,7 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
     uint32 auctions = getNofAuctions(config, auctionHouse, AHBplayer->GetGUID());
     uint32 items    = 0;
 
-    if (auctions >= minItems)
+    if (auctions >= minItems && backlog == 0)
     {
         aboveMin = true;
 
@@ -585,26 +670,52 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
             LOG_ERROR("module", "AHBot [{}]: Auctions above minimum", _id);
         }
 
+        //
+        // Have the worker plan the replacements of the listings lapsing within the next minute
+        //
+
+        uint32 lapsing = config->CountSellerExpiries(now + MINUTE);
+
+        if (lapsing > 0 && gPlanner.IsRunning())
+        {
+            AHBPlanRequest request;
+            fillPlanRequest(config, request);
+
+            request.Count = lapsing;
+
+            gPlanner.Submit(request);
+        }
+
+        config->SleepSeller(_id);
+
         return;
     }
 
     if (auctions >= maxItems)
     {
         aboveMax = true;
+        backlog  = 0;
 
         if (config->DebugOutSeller)
         {
             LOG_ERROR("module", "AHBot [{}]: Auctions at or above maximum", _id);
         }
 
+        config->SleepSeller(_id);
+
         return;
     }
 
-    if ((maxItems - auctions) >= config->ItemsPerCycle)
+    if (backlog > 0)
     {
-        items = config->ItemsPerCycle;
+        items = backlog;
     }
     else
+    {
+        items = config->ItemsPerCycle;
+    }
+
+    if ((maxItems - auctions) < items)
     {
         items = (maxItems - auctions);
     }
@@ -613,37 +724,17 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
     // Retrieve the configuration for this run
     // 
 
-    uint32 greyTGcount   = config->GetMaximum(AHB_GREY_TG);
-    uint32 whiteTGcount  = config->GetMaximum(AHB_WHITE_TG);
-    uint32 greenTGcount  = config->GetMaximum(AHB_GREEN_TG);
-    uint32 blueTGcount   = config->GetMaximum(AHB_BLUE_TG);
-    uint32 purpleTGcount = config->GetMaximum(AHB_PURPLE_TG);
-    uint32 orangeTGcount = config->GetMaximum(AHB_ORANGE_TG);
-    uint32 yellowTGcount = config->GetMaximum(AHB_YELLOW_TG);
-
-    uint32 greyIcount    = config->GetMaximum(AHB_GREY_I);
-    uint32 whiteIcount   = config->GetMaximum(AHB_WHITE_I);
-    uint32 greenIcount   = config->GetMaximum(AHB_GREEN_I);
-    uint32 blueIcount    = config->GetMaximum(AHB_BLUE_I);
-    uint32 purpleIcount  = config->GetMaximum(AHB_PURPLE_I);
-    uint32 orangeIcount  = config->GetMaximum(AHB_ORANGE_I);
-    uint32 yellowIcount  = config->GetMaximum(AHB_YELLOW_I);
-
-    uint32 greyTGoods    = config->GetItemCounts(AHB_GREY_TG);
-    uint32 whiteTGoods   = config->GetItemCounts(AHB_WHITE_TG);
-    uint32 greenTGoods   = config->GetItemCounts(AHB_GREEN_TG);
-    uint32 blueTGoods    = config->GetItemCounts(AHB_BLUE_TG);
-    uint32 purpleTGoods  = config->GetItemCounts(AHB_PURPLE_TG);
-    uint32 orangeTGoods  = config->GetItemCounts(AHB_ORANGE_TG);
-    uint32 yellowTGoods  = config->GetItemCounts(AHB_YELLOW_TG);
-
-    uint32 greyItems     = config->GetItemCounts(AHB_GREY_I);
-    uint32 whiteItems    = config->GetItemCounts(AHB_WHITE_I);
-    uint32 greenItems    = config->GetItemCounts(AHB_GREEN_I);
-    uint32 blueItems     = config->GetItemCounts(AHB_BLUE_I);
-    uint32 purpleItems   = config->GetItemCounts(AHB_PURPLE_I);
-    uint32 orangeItems   = config->GetItemCounts(AHB_ORANGE_I);
-    uint32 yellowItems   = config->GetItemCounts(AHB_YELLOW_I);
+    uint32 maximums[AHB_CATEGORIES];
+    uint32 counts  [AHB_CATEGORIES];
+
+    AHBPlanRequest request;
+    fillPlanRequest(config, request);
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        maximums[category] = config->GetMaximum(category);
+        counts  [category] = config->GetItemCounts(category);
+    }
 
     //
     // Loop variables
@@ -656,154 +747,116 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
     uint32 loopBrk   = 0; // Tracing counter
     uint32 err       = 0; // Tracing counter
 
+    //
+    // All the auctions created in this cycle are saved together, in chunks if configured so
+    //
+
+    auto   trans     = CharacterDatabase.BeginTransaction();
+    uint32 batched   = 0;
+
+    backlog = 0;
+
     for (uint32 cnt = 1; cnt <= items; cnt++)
     {
-        uint32 choice      = 0;
-        uint32 itemID      = 0;
-        uint32 loopbreaker = 0;
-
         //
-        // Select, in rarity order, a new random item
+        // When the time budget for this tick is used up, leave the rest of the refill to the next ones
         //
 
-        while (itemID == 0 && loopbreaker <= AUCTION_HOUSE_BOT_LOOP_BREAKER)
+        if (config->SellerTimeBudget > 0 && cnt > 1)
         {
-            loopbreaker++;
-
-            // Poor
+            uint64 elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 
-            if ((config->GreyItemsBin.size() > 0) && (greyItems < greyIcount))
+            if (elapsed >= config->SellerTimeBudget)
             {
-                choice = 0;
-                itemID = getElement(config->GreyItemsBin, urand(0, config->GreyItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+                backlog = items - cnt + 1;
 
-            if (itemID == 0 && (config->GreyTradeGoodsBin.size() > 0) && (greyTGoods < greyTGcount))
-            {
-                choice = 7;
-                itemID = getElement(config->GreyTradeGoodsBin, urand(0, config->GreyTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            // Normal
-
-            if (itemID == 0 && (config->WhiteItemsBin.size() > 0) && (whiteItems < whiteIcount))
-            {
-                choice = 1;
-                itemID = getElement(config->WhiteItemsBin, urand(0, config->WhiteItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            if (itemID == 0 && (config->WhiteTradeGoodsBin.size() > 0) && (whiteTGoods < whiteTGcount))
-            {
-                choice = 8;
-                itemID = getElement(config->WhiteTradeGoodsBin, urand(0, config->WhiteTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            // Uncommon
+                if (config->DebugOutSeller)
+                {
+                    LOG_INFO("module", "AHBot [{}]: Time budget exhausted after {} us, {} items left for the next ticks", _id, elapsed, backlog);
+                }
 
-            if (itemID == 0 && (config->GreenItemsBin.size() > 0) && (greenItems < greenIcount))
-            {
-                choice = 2;
-                itemID = getElement(config->GreenItemsBin, urand(0, config->GreenItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                break;
             }
+        }
 
-            if (itemID == 0 && (config->GreenTradeGoodsBin.size() > 0) && (greenTGoods < greenTGcount))
-            {
-                choice = 9;
-                itemID = getElement(config->GreenTradeGoodsBin, urand(0, config->GreenTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+        AHBPlannedListing plan;
+        bool              found       = false;
+        bool              exhausted   = false;
+        uint32            loopbreaker = 0;
 
-            // Rare
+        //
+        // Take the next listing planned before or by the worker, or plan a batch of the rest of the cycle here if there is none;
+        // what is left of the batch is kept for the next cycles. The plans are drawn from the quotas of the categories;
+        // they are discarded if the category is full by now or if the item has too many duplicates on sale.
+        //
 
-            if (itemID == 0 && (config->BlueItemsBin.size() > 0) && (blueItems < blueIcount))
-            {
-                choice = 3;
-                itemID = getElement(config->BlueItemsBin, urand(0, config->BlueItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+        while (!found && loopbreaker <= AUCTION_HOUSE_BOT_LOOP_BREAKER)
+        {
+            loopbreaker++;
 
-            if (itemID == 0 && (config->BlueTradeGoodsBin.size() > 0) && (blueTGoods < blueTGcount))
+            if (!plans.empty() || !gPlanner.Next(_id, config->GetAHID(), plan))
             {
-                choice = 10;
-                itemID = getElement(config->BlueTradeGoodsBin, urand(0, config->BlueTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+                if (plans.empty())
+                {
+                    AHBStopwatch planning(_stats.Get(config->GetAHID(), AHB_PHASE_PLAN));
 
-            // Epic
+                    request.Count = minValue(items - cnt + 1, AUCTION_HOUSE_BOT_PLAN_BATCH);
+                    AHBPlanner::Plan(request, plans);
+                }
 
-            if (itemID == 0 && (config->PurpleItemsBin.size() > 0) && (purpleItems < purpleIcount))
-            {
-                choice = 4;
-                itemID = getElement(config->PurpleItemsBin, urand(0, config->PurpleItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+                if (plans.empty())
+                {
+                    exhausted = true;
+                    break;
+                }
 
-            if (itemID == 0 && (config->PurpleTradeGoodsBin.size() > 0) && (purpleTGoods < purpleTGcount))
-            {
-                choice = 11;
-                itemID = getElement(config->PurpleTradeGoodsBin, urand(0, config->PurpleTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                plan = plans.front();
+                plans.pop_front();
             }
 
-            // Legendary
+            uint32 category = plan.Listing->Category;
 
-            if (itemID == 0 && (config->OrangeItemsBin.size() > 0) && (orangeItems < orangeIcount))
+            if (counts[category] >= maximums[category])
             {
-                choice = 5;
-                itemID = getElement(config->OrangeItemsBin, urand(0, config->OrangeItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                noNeed++;
+                continue;
             }
 
-            if (itemID == 0 && (config->OrangeTradeGoodsBin.size() > 0) && (orangeTGoods < orangeTGcount))
+            if (config->DuplicatesCount > 0 && config->GetBotItemCounts(_id, plan.Listing->ItemId) >= config->DuplicatesCount)
             {
-                choice = 12;
-                itemID = getElement(config->OrangeTradeGoodsBin, urand(0, config->OrangeTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                tooMany++;
+                continue;
             }
 
-            // Artifact
+            found = true;
+        }
 
-            if (itemID == 0 && (config->YellowItemsBin.size() > 0) && (yellowItems < yellowIcount))
-            {
-                choice = 6;
-                itemID = getElement(config->YellowItemsBin, urand(0, config->YellowItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+        if (exhausted)
+        {
+            binEmpty++;
 
-            if (itemID == 0 && (config->YellowTradeGoodsBin.size() > 0) && (yellowTGoods < yellowTGcount))
+            if (config->DebugOutSeller)
             {
-                choice = 13;
-                itemID = getElement(config->YellowTradeGoodsBin, urand(0, config->YellowTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                LOG_ERROR("module", "AHBot [{}]: No item could be selected from the bins", _id);
             }
 
-            if (itemID == 0)
-            {
-                binEmpty++;
-            
-                if (config->DebugOutSeller)
-                {
-                    LOG_ERROR("module", "AHBot [{}]: No item could be selected from the bins", _id);
-                }
-            
-                break;
-            }
+            break;
         }
 
-        if (itemID == 0 || loopbreaker > AUCTION_HOUSE_BOT_LOOP_BREAKER)
+        if (!found)
         {
             loopBrk++;
             continue;
         }
 
+        AHBListing const* listing = plan.Listing;
+        uint32            itemID  = listing->ItemId;
+
         // 
-        // Retrieve information about the selected item
+        // Create the item; everything else about it is already known from the plan
         // 
 
-        ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(itemID);
-
-        if (prototype == NULL)
-        {
-            err++;
-
-            if (config->DebugOutSeller)
-            {
-                LOG_ERROR("module", "AHBot [{}]: could not get prototype of item {}", _id, itemID);
-            }
-
-            continue;
-        }
+        std::chrono::steady_clock::time_point created = std::chrono::steady_clock::now();
 
         Item* item = Item::CreateItem(itemID, 1, AHBplayer);
 
@@ -825,33 +878,23 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
 
         item->AddToUpdateQueueOf(AHBplayer);
 
-        uint32 randomPropertyId = Item::GenerateItemRandomPropertyId(itemID);
-
-        if (randomPropertyId != 0)
-        {
-            item->SetItemRandomProperties(randomPropertyId);
-        }
-
-        if (prototype->Quality > AHB_MAX_QUALITY)
+        if (listing->RandomProperty)
         {
-            err++;
+            uint32 randomPropertyId = Item::GenerateItemRandomPropertyId(itemID);
 
-            if (config->DebugOutSeller)
+            if (randomPropertyId != 0)
             {
-                LOG_ERROR("module", "AHBot [{}]: Quality {} TOO HIGH for item {}", _id, prototype->Quality, itemID);
+                item->SetItemRandomProperties(randomPropertyId);
             }
-
-            item->RemoveFromUpdateQueueOf(AHBplayer);
-            continue;
         }
 
         // 
-        // Determine the price
+        // Determine the price; the market price, which is known only here, replaces the base one
         // 
 
         uint64 buyoutPrice = 0;
         uint64 bidPrice    = 0;
-        uint32 stackCount  = 1;
+        uint32 stackCount  = plan.StackCount;
 
         if (config->SellAtMarketPrice)
         {
@@ -860,46 +903,22 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
 
         if (buyoutPrice == 0)
         {
-            if (config->SellMethod)
-            {
-                buyoutPrice = prototype->BuyPrice;
-            }
-            else
-            {
-                buyoutPrice = prototype->SellPrice;
-            }
+            buyoutPrice = listing->BasePrice;
         }
 
-        buyoutPrice = buyoutPrice * urand(config->GetMinPrice(prototype->Quality), config->GetMaxPrice(prototype->Quality));
+        buyoutPrice = buyoutPrice * plan.PriceFactor;
         buyoutPrice = buyoutPrice / 100;
 
-        bidPrice    = buyoutPrice * urand(config->GetMinBidPrice(prototype->Quality), config->GetMaxBidPrice(prototype->Quality));
+        bidPrice    = buyoutPrice * plan.BidFactor;
         bidPrice    = bidPrice / 100;
 
-        // 
-        // Determine the stack size
-        // 
-
-        if (config->GetMaxStack(prototype->Quality) > 1 && item->GetMaxStackCount() > 1)
-        {
-            stackCount = minValue(getStackCount(config, item->GetMaxStackCount()), config->GetMaxStack(prototype->Quality));
-        }
-        else if (config->GetMaxStack(prototype->Quality) == 0 && item->GetMaxStackCount() > 1)
-        {
-            stackCount = getStackCount(config, item->GetMaxStackCount());
-        }
-        else
-        {
-            stackCount = 1;
-        }
-
         item->SetCount(stackCount);
 
         // 
         // Determine the auction time
         // 
 
-        uint32 etime = getElapsedTime(config->ElapsingTimeClass);
+        uint32 etime = plan.ElapsedTime;
 
         // 
         // Determine the deposit
@@ -911,8 +930,6 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         // Perform the auction
         // 
 
-        auto trans = CharacterDatabase.BeginTransaction();
-
         AuctionEntry* auctionEntry      = new AuctionEntry();
         auctionEntry->Id                = sObjectMgr->GenerateAuctionID();
         auctionEntry->houseId           = config->GetAHID();
@@ -933,85 +950,80 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         auctionHouse->AddAuction(auctionEntry);
         auctionEntry->SaveToDB(trans);
 
-        CharacterDatabase.CommitTransaction(trans);
+        _stats.Get(config->GetAHID(), AHB_PHASE_CREATE).Record(created);
 
-        // 
-        // Increments the number of items presents in the auction
-        // 
+        batched++;
 
-        switch (choice)
+        if (config->ListingsPerTransaction > 0 && batched >= config->ListingsPerTransaction)
         {
-        case 0:
-            ++greyItems;
-            break;
-
-        case 1:
-            ++whiteItems;
-            break;
-
-        case 2:
-            ++greenItems;
-            break;
-
-        case 3:
-            ++blueItems;
-            break;
+            AHBStopwatch flush(_stats.Get(config->GetAHID(), AHB_PHASE_FLUSH));
 
-        case 4:
-            ++purpleItems;
-            break;
+            CharacterDatabase.CommitTransaction(trans);
 
-        case 5:
-            ++orangeItems;
-            break;
+            trans   = CharacterDatabase.BeginTransaction();
+            batched = 0;
+        }
 
-        case 6:
-            ++yellowItems;
-            break;
+        // 
+        // Increments the number of items presents in the auction
+        // 
 
-        case 7:
-            ++greyTGoods;
-            break;
+        counts[listing->Category]++;
 
-        case 8:
-            ++whiteTGoods;
-            break;
+        if (request.Weights[listing->Category] > 0)
+        {
+            request.Weights[listing->Category]--;
+        }
 
-        case 9:
-            ++greenTGoods;
-            break;
+        noSold++;
 
-        case 10:
-            ++blueTGoods;
-            break;
+        if (config->TraceSeller)
+        {
+            LOG_INFO("module", "AHBot [{}]: New stack ah={}, id={}, stack={}, bid={}, buyout={}", _id, config->GetAHID(), itemID, stackCount, auctionEntry->startbid, auctionEntry->buyout);
+        }
+    }
 
-        case 11:
-            ++purpleTGoods;
-            break;
+    //
+    // Save whatever is left in the batch
+    //
 
-        case 12:
-            ++orangeTGoods;
-            break;
+    if (batched > 0)
+    {
+        AHBStopwatch flush(_stats.Get(config->GetAHID(), AHB_PHASE_FLUSH));
 
-        case 13:
-            ++yellowTGoods;
-            break;
+        CharacterDatabase.CommitTransaction(trans);
+    }
 
-        default:
-            break;
-        }
+    //
+    // Have the worker prepare the listings of the next cycle, from the quotas left after this one
+    //
 
-        noSold++;
+    if (gPlanner.IsRunning())
+    {
+        request.Count = config->ItemsPerCycle;
 
-        if (config->TraceSeller)
+        for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
         {
-            LOG_INFO("module", "AHBot [{}]: New stack ah={}, id={}, stack={}, bid={}, buyout={}", _id, config->GetAHID(), itemID, stackCount, auctionEntry->startbid, auctionEntry->buyout);
+            request.Weights[category] = counts[category] < maximums[category] ? maximums[category] - counts[category] : 0;
         }
+
+        gPlanner.Submit(request);
     }
 
+    //
+    // Accumulate the outcomes of the cycle for the statistics
+    //
+
+    _stats.Add(config->GetAHID(), AHB_COUNTER_SOLD      , noSold);
+    _stats.Add(config->GetAHID(), AHB_COUNTER_BIN_EMPTY , binEmpty);
+    _stats.Add(config->GetAHID(), AHB_COUNTER_NO_NEED   , noNeed);
+    _stats.Add(config->GetAHID(), AHB_COUNTER_TOO_MANY  , tooMany);
+    _stats.Add(config->GetAHID(), AHB_COUNTER_LOOP_BREAK, loopBrk);
+    _stats.Add(config->GetAHID(), AHB_COUNTER_ERROR     , err);
+
     if (config->TraceSeller)
     {
-        LOG_INFO("module", "AHBot [{}]: auctionhouse {}, req={}, sold={}, aboveMin={}, aboveMax={}, loopBrk={}, noNeed={}, tooMany={}, binEmpty={}, err={}", _id, config->GetAHID(), items, noSold, aboveMin, aboveMax, loopBrk, noNeed, tooMany, binEmpty, err);
+        LOG_INFO("module", "AHBot [{}]: auctionhouse {}, req={}, sold={}, aboveMin={}, aboveMax={}, loopBrk={}, noNeed={}, tooMany={}, binEmpty={}, err={}, backlog={}", _id, config->GetAHID(), items, noSold, aboveMin, aboveMax, loopBrk, noNeed, tooMany, binEmpty, err, backlog);
     }
 }
 
@@ -1032,73 +1044,123 @@ void AuctionHouseBot::Update()
         return;
     }
 
+    AHBStopwatch watch(_stats.GetUpdate());
+
     //
-    // Preprare for operation
+    // Preprare for operation; the session and the character are created only once and reused by the following updates
     //
 
-    std::string accountName = "AuctionHouseBot" + std::to_string(_account);
+    if (!_AHBplayer)
+    {
+        std::string accountName = "AuctionHouseBot" + std::to_string(_account);
+
+        _session   = new WorldSession(_account, std::move(accountName), nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+        _AHBplayer = new Player(_session);
 
-    WorldSession _session(_account, std::move(accountName), nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+        _AHBplayer->Initialize(_id);
+    }
 
-    Player _AHBplayer(&_session);
-    _AHBplayer.Initialize(_id);
+    //
+    // The character is visible to the rest of the world only while the bot is operating
+    //
 
-    ObjectAccessor::AddObject(&_AHBplayer);
+    ObjectAccessor::AddObject(_AHBplayer);
 
     //
-    // Perform update for the factions markets
+    // Collect the factions markets to update
     //
 
+    std::vector<AHBHousePass> passes;
+
     if (!sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
     {
-        //
-        // Alliance
-        //
-
         if (_allianceConfig)
         {
-            Sell(&_AHBplayer, _allianceConfig);
+            passes.push_back(AHBHousePass(_allianceConfig, &_backlog_a, &_plans_a, &_lastrun_a_sec));
+        }
 
-            if (((_newrun - _lastrun_a_sec) >= (_allianceConfig->GetBiddingInterval() * MINUTE)) && (_allianceConfig->GetBidsPerInterval() > 0))
-            {
-                Buy(&_AHBplayer, _allianceConfig, &_session);
-                _lastrun_a_sec = _newrun;
-            }
+        if (_hordeConfig)
+        {
+            passes.push_back(AHBHousePass(_hordeConfig, &_backlog_h, &_plans_h, &_lastrun_h_sec));
         }
+    }
 
-        //
-        // Horde
-        //
+    if (_neutralConfig)
+    {
+        passes.push_back(AHBHousePass(_neutralConfig, &_backlog_n, &_plans_n, &_lastrun_n_sec));
+    }
 
-        if (_hordeConfig)
+    for (AHBHousePass& pass: passes)
+    {
+        pass.Bid = ((_newrun - *pass.LastRun) >= (pass.Config->GetBiddingInterval() * MINUTE)) && (pass.Config->GetBidsPerInterval() > 0);
+    }
+
+    //
+    // The markets are independent: plan the listings and choose the bids of all of them at once on the
+    // workers, if enabled, otherwise one market at a time right before its operations
+    //
+
+    bool parallel = gPool.IsRunning() && passes.size() > 1;
+
+    if (parallel)
+    {
+        std::vector<std::function<void()>> tasks;
+
+        for (AHBHousePass& pass: passes)
         {
-            Sell(&_AHBplayer, _hordeConfig);
+            AHBHousePass* house = &pass;
 
-            if (((_newrun - _lastrun_h_sec) >= (_hordeConfig->GetBiddingInterval() * MINUTE)) && (_hordeConfig->GetBidsPerInterval() > 0))
+            tasks.push_back([this, house]()
             {
-                Buy(&_AHBplayer, _hordeConfig, &_session);
-                _lastrun_h_sec = _newrun;
-            }
+                PlanSell(_AHBplayer, house->Config, *house->Backlog, *house->Plans);
+
+                if (house->Bid)
+                {
+                    ChooseBids(_AHBplayer, house->Config, house->Picks);
+                }
+            });
         }
 
+        gPool.Run(tasks);
     }
 
     //
-    // Neutral
+    // Perform update for the factions markets
     //
 
-    if (_neutralConfig)
+    for (AHBHousePass& pass: passes)
     {
-        Sell(&_AHBplayer, _neutralConfig);
+        Sell(_AHBplayer, pass.Config, *pass.Backlog, *pass.Plans);
 
-        if (((_newrun - _lastrun_n_sec) >= (_neutralConfig->GetBiddingInterval() * MINUTE)) && (_neutralConfig->GetBidsPerInterval() > 0))
+        if (pass.Bid)
         {
-            Buy(&_AHBplayer, _neutralConfig, &_session);
-            _lastrun_n_sec = _newrun;
+            if (!parallel)
+            {
+                ChooseBids(_AHBplayer, pass.Config, pass.Picks);
+            }
+
+            Buy(_AHBplayer, pass.Config, _session, pass.Picks);
+            *pass.LastRun = _newrun;
         }
     }
 
-    ObjectAccessor::RemoveObject(&_AHBplayer);
+    ObjectAccessor::RemoveObject(_AHBplayer);
+}
+
+// =============================================================================
+// Report the timings of the bot and the work it has left
+// =============================================================================
+
+void AuctionHouseBot::ReportStats(std::vector<std::string>& lines)
+{
+    _stats.Report(_id, lines);
+
+    lines.push_back(Acore::StringFormat("bot {} backlog: alliance={} horde={} neutral={}", _id, _backlog_a, _backlog_h, _backlog_n));
+}
+
+void AuctionHouseBot::ResetStats()
+{
+    _stats.Reset();
 }
 
 // =============================================================================
@@ -1243,6 +1305,13 @@ void AuctionHouseBot::Commands(AHBotCommand command, uint32 ahMapID, uint32 col,
                 // Expired NOW.
                 itr->second->expire_time = GameTime::GetGameTime().count();
 
+                //
+                // Move the auction in the wheel of the seller as well, so that it is dropped at the next update
+                //
+
+                config->RemoveSellerExpiry(itr->second->Id);
+                config->AddSellerExpiry   (itr->second);
+
                 uint32 id                = itr->second->Id;
                 uint32 expire_time       = itr->second->expire_time;
 
@@ -20,18 +20,41 @@
 #ifndef AUCTION_HOUSE_BOT_H
 #define AUCTION_HOUSE_BOT_H
 
+#include <deque>
+#include <string>
+#include <vector>
+
 #include "Common.h"
 #include "ObjectGuid.h"
 #include "AuctionHouseMgr.h"
 
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotStats.h"
 
 struct AuctionEntry;
 class  Player;
 class  WorldSession;
 
 #define AUCTION_HOUSE_BOT_LOOP_BREAKER 32
+#define AUCTION_HOUSE_BOT_PLAN_BATCH   64  // Listings planned at once by the seller, so that the time budget is checked often enough
+
+//
+// Work of a bot on an auction house during an update
+//
+
+struct AHBHousePass
+{
+    AHBConfig*                     Config;
+    uint32*                        Backlog; // Listings left by the previous seller cycle
+    std::deque<AHBPlannedListing>* Plans;   // Listings planned and not used yet by the previous seller cycles
+    time_t*                        LastRun; // Time of the last bidding
+    bool                           Bid;     // The bidding interval elapsed
+    std::vector<uint32>            Picks;   // Auctions the buyer is going to bid on
+
+    AHBHousePass(AHBConfig* config, uint32* backlog, std::deque<AHBPlannedListing>* plans, time_t* lastRun) : Config(config), Backlog(backlog), Plans(plans), LastRun(lastRun), Bid(false) { }
+};
 
 class AuctionHouseBot
 {
@@ -47,12 +70,40 @@ private:
     time_t     _lastrun_h_sec;
     time_t     _lastrun_n_sec;
 
+    uint32     _backlog_a;
+    uint32     _backlog_h;
+    uint32     _backlog_n;
+
+    //
+    // Listings planned for each auction house and left over by the seller, used first by the next cycle
+    //
+
+    std::deque<AHBPlannedListing> _plans_a;
+    std::deque<AHBPlannedListing> _plans_h;
+    std::deque<AHBPlannedListing> _plans_n;
+
+    //
+    // Session and character of the bot, created at the first update and kept until the bot is deleted
+    //
+
+    WorldSession* _session;
+    Player*       _AHBplayer;
+
+    //
+    // Timings of the operations
+    //
+
+    AHBStats      _stats;
+
     //
     // Main operations
     //
 
-    void Sell(Player *AHBplayer, AHBConfig *config);
-    void Buy (Player *AHBplayer, AHBConfig *config, WorldSession *session);
+    void PlanSell  (Player *AHBplayer, AHBConfig *config, uint32 backlog, std::deque<AHBPlannedListing>& plans);
+    void ChooseBids(Player *AHBplayer, AHBConfig *config, std::vector<uint32>& picks);
+
+    void Sell      (Player *AHBplayer, AHBConfig *config, uint32& backlog, std::deque<AHBPlannedListing>& plans);
+    void Buy       (Player *AHBplayer, AHBConfig *config, WorldSession *session, std::vector<uint32> const& picks);
 
     //
     // Utilities
@@ -61,9 +112,8 @@ private:
     inline uint32 minValue(uint32 a, uint32 b) { return a <= b ? a : b; };
 
     uint32 getNofAuctions(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid);
-    uint32 getStackCount(AHBConfig* config, uint32 max);
-    uint32 getElapsedTime(uint32 timeClass);
-    uint32 getElement(std::set<uint32> set, int index, uint32 botId, uint32 maxDup, AuctionHouseObject* auctionHouse);
+
+    void   fillPlanRequest(AHBConfig* config, AHBPlanRequest& request);
 
 public:
     AuctionHouseBot(uint32 account, uint32 id);
@@ -74,6 +124,11 @@ public:
 
     void Commands(AHBotCommand command, uint32 ahMapID, uint32 col, char* args);
 
+    void ReportStats(std::vector<std::string>& lines);
+    void ResetStats ();
+
+    AHBStats& GetStats() { return _stats; };
+
     ObjectGuid::LowType GetAHBplayerGUID() { return _id; };
 };
 
@@ -7,11 +7,12 @@
 
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotMetrics.h"
 #include "AuctionHouseBotAuctionHouseScript.h"
 
 AHBot_AuctionHouseScript::AHBot_AuctionHouseScript() : AuctionHouseScript("AHBot_AuctionHouseScript")
 {
-
+    _cursor = 0;
 }
 
 void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrSendAuctionSuccessfulMail(
@@ -99,13 +100,29 @@ void AHBot_AuctionHouseScript::OnAuctionAdd(AuctionHouseObject* /*ah*/, AuctionE
         }
     }
 
+    //
+    // Keep track of the items listed by the bots, used to limit the duplicates and the refills,
+    // and of the ones listed by the players, which the buyer can bid on
+    //
+
+    if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+    {
+        config->IncBotItemCounts   (auction->owner.GetCounter(), auction->item_template);
+        config->IncBotAuctionCounts(auction->owner.GetCounter());
+        config->AddSellerExpiry    (auction);
+    }
+    else
+    {
+        config->AddBuyerCandidate(auction);
+    }
+
     // 
     // Consider only those auctions handled by the bots
     // 
 
     if (config->ConsiderOnlyBotAuctions)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+        if (gBotsId.find(auction->owner.GetCounter()) == gBotsId.end())
         {
             return;
         }
@@ -162,13 +179,35 @@ void AHBot_AuctionHouseScript::OnAuctionRemove(AuctionHouseObject* /*ah*/, Aucti
         }
     }
 
+    //
+    // Keep track of the items listed by the bots, used to limit the duplicates and the refills,
+    // and of the ones listed by the players, which the buyer can bid on
+    //
+
+    if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+    {
+        config->DecBotItemCounts   (auction->owner.GetCounter(), auction->item_template);
+        config->DecBotAuctionCounts(auction->owner.GetCounter());
+        config->RemoveSellerExpiry (auction->Id);
+    }
+    else
+    {
+        config->RemoveBuyerCandidate(auction->Id);
+    }
+
+    //
+    // There is room for new listings
+    //
+
+    config->WakeSellers();
+
     // 
     // Consider only those auctions handled by the bots
     // 
 
     if (config->ConsiderOnlyBotAuctions)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+        if (gBotsId.find(auction->owner.GetCounter()) == gBotsId.end())
         {
             return;
         }
@@ -231,6 +270,8 @@ void AHBot_AuctionHouseScript::OnAuctionSuccessful(AuctionHouseObject* /*ah*/, A
     // 
 
     config->UpdateItemStats(auction->item_template, auction->itemCount, auction->buyout);
+
+    config->WakeSellers();
 }
 
 void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, AuctionEntry* auction)
@@ -260,16 +301,47 @@ void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, Aucti
     // 
 
     config->UpdateItemStats(auction->item_template, auction->itemCount, auction->bid);
+
+    config->WakeSellers();
 }
 
 void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrUpdate()
 {
+    if (gBots.empty())
+    {
+        return;
+    }
+
     //
-    // For every registered bot, perform an update
+    // Update the registered bots in turns, a limited amount at each tick if so configured
     //
 
-    for (AuctionHouseBot* bot: gBots)
+    uint32 size  = gBots.size();
+    uint32 count = gBotsPerTick > 0 && gBotsPerTick < size ? gBotsPerTick : size;
+
+    if (_cursor >= size)
+    {
+        _cursor = 0;
+    }
+
+    std::set<AuctionHouseBot*>::iterator it = gBots.begin();
+    std::advance(it, _cursor);
+
+    for (uint32 i = 0; i < count; ++i)
     {
-        bot->Update();
+        (*it)->Update();
+
+        if (++it == gBots.end())
+        {
+            it = gBots.begin();
+        }
     }
+
+    _cursor = (_cursor + count) % size;
+
+    //
+    // Export the statistics, when it is time to
+    //
+
+    gMetrics.Update();
 }
@@ -14,6 +14,9 @@
 
 class AHBot_AuctionHouseScript : public AuctionHouseScript
 {
+private:
+    uint32 _cursor; // Position in the bots list of the next bot to update
+
 public:
     AHBot_AuctionHouseScript();
 
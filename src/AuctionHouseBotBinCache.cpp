@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <type_traits>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "Log.h"
+
+#include "AuctionHouseBotBinCache.h"
+
+//
+// Layout of the file: the header, the item ids of the sources, then every house followed by its listings.
+// The listings are stored as they are in memory, so the file is only read back by the same build.
+//
+
+#define AHB_BIN_CACHE_MAGIC   "AHBBINS"
+#define AHB_BIN_CACHE_VERSION 1
+
+struct AHBBinCacheHeader
+{
+    char   Magic[8];
+    uint32 Version;
+    uint32 ListingSize;
+    uint64 Fingerprint;
+    uint32 NpcItems;
+    uint32 LootItems;
+    uint32 DisabledItems;
+    uint32 Houses;
+};
+
+struct AHBBinCacheHouse
+{
+    uint64 Options;
+    uint32 AHID;
+    uint32 Bins[AHB_CATEGORIES];
+    uint32 Reserved;
+};
+
+static_assert(std::is_trivially_copyable<AHBListing>::value, "the listings are copied from and to the cache file as they are");
+
+AHBBinCache::AHBBinCache()
+{
+    _fingerprint = 0;
+    _loaded      = false;
+    _changed     = false;
+    _hasSources  = false;
+}
+
+AHBBinCache::~AHBBinCache()
+{
+}
+
+bool AHBBinCache::IsEnabled() const
+{
+    return !_path.empty();
+}
+
+bool AHBBinCache::Open(std::string const& path, uint64 fingerprint)
+{
+    _path        = path;
+    _fingerprint = fingerprint;
+    _loaded      = false;
+    _changed     = false;
+    _hasSources  = false;
+
+    _houses.clear();
+
+    if (_path.empty())
+    {
+        return false;
+    }
+
+    //
+    // A missing file is not an error: it is written after the first loading
+    //
+
+    if (!std::ifstream(_path, std::ios::in | std::ios::binary))
+    {
+        return false;
+    }
+
+    try
+    {
+        boost::iostreams::mapped_file_source file(_path);
+
+        _loaded = read(file.data(), file.size());
+    }
+    catch (std::exception const& e)
+    {
+        LOG_ERROR("module", "AHBot: Cannot map the bins cache {}: {}", _path, e.what());
+        _loaded = false;
+    }
+
+    if (!_loaded)
+    {
+        _hasSources = false;
+        _houses.clear();
+    }
+
+    return _loaded;
+}
+
+bool AHBBinCache::read(char const* data, size_t size)
+{
+    size_t            offset = 0;
+    AHBBinCacheHeader header;
+
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    offset += sizeof(header);
+
+    //
+    // A file of another version, build or data is simply ignored, and replaced later
+    //
+
+    if (memcmp(header.Magic, AHB_BIN_CACHE_MAGIC, sizeof(header.Magic)) != 0 || header.Version != AHB_BIN_CACHE_VERSION || header.ListingSize != sizeof(AHBListing))
+    {
+        return false;
+    }
+
+    if (header.Fingerprint != _fingerprint)
+    {
+        return false;
+    }
+
+    std::vector<uint32>* sources[] = { &_npcItems, &_lootItems, &_disabledItems };
+    uint32               counts[]  = { header.NpcItems, header.LootItems, header.DisabledItems };
+
+    for (uint32 source = 0; source < 3; ++source)
+    {
+        size_t bytes = size_t(counts[source]) * sizeof(uint32);
+
+        if (size - offset < bytes)
+        {
+            return false;
+        }
+
+        sources[source]->resize(counts[source]);
+
+        if (bytes)
+        {
+            memcpy(sources[source]->data(), data + offset, bytes);
+        }
+
+        offset += bytes;
+    }
+
+    _hasSources = true;
+
+    for (uint32 house = 0; house < header.Houses; ++house)
+    {
+        AHBBinCacheHouse record;
+
+        if (size - offset < sizeof(record))
+        {
+            return false;
+        }
+
+        memcpy(&record, data + offset, sizeof(record));
+        offset += sizeof(record);
+
+        House& entry = _houses[record.AHID];
+
+        entry.Options = record.Options;
+
+        for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+        {
+            size_t bytes = size_t(record.Bins[category]) * sizeof(AHBListing);
+
+            if (size - offset < bytes)
+            {
+                return false;
+            }
+
+            entry.Bins[category].resize(record.Bins[category]);
+
+            if (bytes)
+            {
+                memcpy(entry.Bins[category].data(), data + offset, bytes);
+            }
+
+            offset += bytes;
+        }
+    }
+
+    return offset == size;
+}
+
+bool AHBBinCache::Save()
+{
+    if (_path.empty() || !_changed)
+    {
+        return true;
+    }
+
+    AHBBinCacheHeader header = AHBBinCacheHeader();
+
+    memcpy(header.Magic, AHB_BIN_CACHE_MAGIC, sizeof(header.Magic));
+
+    header.Version       = AHB_BIN_CACHE_VERSION;
+    header.ListingSize   = sizeof(AHBListing);
+    header.Fingerprint   = _fingerprint;
+    header.NpcItems      = _npcItems.size();
+    header.LootItems     = _lootItems.size();
+    header.DisabledItems = _disabledItems.size();
+    header.Houses        = _houses.size();
+
+    //
+    // Write aside and rename, so that a server stopped in the middle never leaves a partial file
+    //
+
+    std::string   temporary = _path + ".tmp";
+    std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        LOG_ERROR("module", "AHBot: Cannot write the bins cache {}", temporary);
+        return false;
+    }
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    for (std::vector<uint32> const* source: { &_npcItems, &_lootItems, &_disabledItems })
+    {
+        file.write(reinterpret_cast<char const*>(source->data()), source->size() * sizeof(uint32));
+    }
+
+    for (std::map<uint32, House>::const_iterator itr = _houses.begin(); itr != _houses.end(); ++itr)
+    {
+        AHBBinCacheHouse record = AHBBinCacheHouse();
+
+        record.Options = itr->second.Options;
+        record.AHID    = itr->first;
+
+        for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+        {
+            record.Bins[category] = itr->second.Bins[category].size();
+        }
+
+        file.write(reinterpret_cast<char const*>(&record), sizeof(record));
+
+        for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+        {
+            file.write(reinterpret_cast<char const*>(itr->second.Bins[category].data()), itr->second.Bins[category].size() * sizeof(AHBListing));
+        }
+    }
+
+    file.close();
+
+    if (!file || std::rename(temporary.c_str(), _path.c_str()) != 0)
+    {
+        LOG_ERROR("module", "AHBot: Cannot write the bins cache {}", _path);
+        std::remove(temporary.c_str());
+
+        return false;
+    }
+
+    _changed = false;
+
+    return true;
+}
+
+bool AHBBinCache::GetSources(std::vector<uint32>& npcItems, std::vector<uint32>& lootItems, std::vector<uint32>& disabledItems) const
+{
+    if (!_hasSources)
+    {
+        return false;
+    }
+
+    npcItems      = _npcItems;
+    lootItems     = _lootItems;
+    disabledItems = _disabledItems;
+
+    return true;
+}
+
+void AHBBinCache::SetSources(std::vector<uint32> const& npcItems, std::vector<uint32> const& lootItems, std::vector<uint32> const& disabledItems)
+{
+    if (_path.empty())
+    {
+        return;
+    }
+
+    _npcItems      = npcItems;
+    _lootItems     = lootItems;
+    _disabledItems = disabledItems;
+
+    _hasSources    = true;
+    _changed       = true;
+}
+
+bool AHBBinCache::GetBins(uint32 ahid, uint64 options, std::vector<AHBListing> (&bins)[AHB_CATEGORIES]) const
+{
+    std::map<uint32, House>::const_iterator itr = _houses.find(ahid);
+
+    if (itr == _houses.end() || itr->second.Options != options)
+    {
+        return false;
+    }
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        bins[category] = itr->second.Bins[category];
+    }
+
+    return true;
+}
+
+void AHBBinCache::SetBins(uint32 ahid, uint64 options, AHBConfig* config)
+{
+    if (_path.empty())
+    {
+        return;
+    }
+
+    //
+    // Nothing to write if the bins came from the cache in the first place
+    //
+
+    std::map<uint32, House>::const_iterator itr = _houses.find(ahid);
+
+    if (itr != _houses.end() && itr->second.Options == options)
+    {
+        return;
+    }
+
+    House& entry = _houses[ahid];
+
+    entry.Options = options;
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        entry.Bins[category] = config->GetBin(category);
+    }
+
+    _changed = true;
+}
+
+uint64 AHBBinCache::Hash(uint64 hash, void const* data, size_t size)
+{
+    unsigned char const* bytes = static_cast<unsigned char const*>(data);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_BIN_CACHE_H
+#define AUCTION_HOUSE_BOT_BIN_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotConfig.h"
+
+// =============================================================================
+// Snapshot on disk of the sources of the items and of the bins of the auction
+// houses, so that a restart with the same data skips the queries and the
+// filtering. The snapshot is valid only for the fingerprint of the templates
+// and tables it was built from; the bins of each house are kept with a hash of
+// the options that filtered them.
+// =============================================================================
+
+class AHBBinCache
+{
+private:
+    struct House
+    {
+        uint64                  Options;
+        std::vector<AHBListing> Bins[AHB_CATEGORIES];
+    };
+
+    std::string            _path;
+    uint64                 _fingerprint;
+    bool                   _loaded;   // The file matched the fingerprint
+    bool                   _changed;  // Something must be written back
+
+    bool                   _hasSources;
+    std::vector<uint32>    _npcItems;
+    std::vector<uint32>    _lootItems;
+    std::vector<uint32>    _disabledItems;
+
+    std::map<uint32, House> _houses;
+
+    bool   read (char const* data, size_t size);
+
+public:
+    AHBBinCache();
+    ~AHBBinCache();
+
+    bool   Open (std::string const& path, uint64 fingerprint);
+    bool   Save ();
+
+    bool   IsEnabled() const;
+
+    bool   GetSources(std::vector<uint32>& npcItems, std::vector<uint32>& lootItems, std::vector<uint32>& disabledItems) const;
+    void   SetSources(std::vector<uint32> const& npcItems, std::vector<uint32> const& lootItems, std::vector<uint32> const& disabledItems);
+
+    bool   GetBins   (uint32 ahid, uint64 options, std::vector<AHBListing> (&bins)[AHB_CATEGORIES]) const;
+    void   SetBins   (uint32 ahid, uint64 options, AHBConfig* config);
+
+    //
+    // FNV-1a, for the fingerprint and the options
+    //
+
+    static uint64 Hash(uint64 hash, void const* data, size_t size);
+
+    template<typename T>
+    static uint64 Hash(uint64 hash, T value) { return Hash(hash, &value, sizeof(value)); }
+
+    static uint64 const HashSeed = 14695981039346656037ULL;
+};
+
+#endif // AUCTION_HOUSE_BOT_BIN_CACHE_H
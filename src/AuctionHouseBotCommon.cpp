@@ -5,6 +5,9 @@
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotMetrics.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotPool.h"
 
 // 
 // Configuration used globally by all the bots instances
@@ -20,3 +23,22 @@ AHBConfig* gNeutralConfig  = new AHBConfig(7);
 
 std::set<uint32>           gBotsId;
 std::set<AuctionHouseBot*> gBots;
+uint32                     gBotsPerTick = 0;
+
+// 
+// Worker planning the listings of the sellers
+// 
+
+AHBPlanner                 gPlanner;
+
+// 
+// Workers processing the auction houses in parallel
+// 
+
+AHBWorkerPool              gPool;
+
+// 
+// Writer of the metrics file
+// 
+
+AHBMetrics                 gMetrics;
@@ -71,6 +71,8 @@ class AuctionHouseBot;
 #define AHB_ORANGE_I         12
 #define AHB_YELLOW_I         13
 
+#define AHB_CATEGORIES       14
+
 //
 // Chat GM commands
 //
@@ -99,7 +101,8 @@ enum class AHBotCommand : uint32
 // Globals
 //
 
-extern std::set<uint32>           gBotsId; // Active bots players ids
-extern std::set<AuctionHouseBot*> gBots;   // Active bots
+extern std::set<uint32>           gBotsId;      // Active bots players ids
+extern std::set<AuctionHouseBot*> gBots;        // Active bots
+extern uint32                     gBotsPerTick; // Bots updated at each world tick, zero for all of them
 
 #endif // AUCTION_HOUSE_BOT_COMMON_H
@@ -17,6 +17,9 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
+#include <utility>
+
 #include "AuctionHouseMgr.h"
 #include "Common.h"
 #include "Config.h"
@@ -25,13 +28,48 @@
 #include "ItemTemplate.h"
 #include "Log.h"
 #include "ObjectMgr.h"
+#include "Random.h"
 #include "WorldSession.h"
 
+#include "AuctionHouseBot.h"
+#include "AuctionHouseBotBinCache.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
 
 using namespace std;
 
+//
+// Columns of mod_auctionhousebot read by the bot, besides the auction house id
+//
+
+static char const* const AHBHouseColumns[] =
+{
+    "minitems"               , "maxitems",
+
+    "percentgreytradegoods"  , "percentwhitetradegoods", "percentgreentradegoods" , "percentbluetradegoods",
+    "percentpurpletradegoods", "percentorangetradegoods", "percentyellowtradegoods",
+    "percentgreyitems"       , "percentwhiteitems"     , "percentgreenitems"      , "percentblueitems",
+    "percentpurpleitems"     , "percentorangeitems"    , "percentyellowitems",
+
+    "minpricegrey"           , "maxpricegrey"          , "minpricewhite"          , "maxpricewhite",
+    "minpricegreen"          , "maxpricegreen"         , "minpriceblue"           , "maxpriceblue",
+    "minpricepurple"         , "maxpricepurple"        , "minpriceorange"         , "maxpriceorange",
+    "minpriceyellow"         , "maxpriceyellow",
+
+    "minbidpricegrey"        , "maxbidpricegrey"       , "minbidpricewhite"       , "maxbidpricewhite",
+    "minbidpricegreen"       , "maxbidpricegreen"      , "minbidpriceblue"        , "maxbidpriceblue",
+    "minbidpricepurple"      , "maxbidpricepurple"     , "minbidpriceorange"      , "maxbidpriceorange",
+    "minbidpriceyellow"      , "maxbidpriceyellow",
+
+    "maxstackgrey"           , "maxstackwhite"         , "maxstackgreen"          , "maxstackblue",
+    "maxstackpurple"         , "maxstackorange"        , "maxstackyellow",
+
+    "buyerpricegrey"         , "buyerpricewhite"       , "buyerpricegreen"        , "buyerpriceblue",
+    "buyerpricepurple"       , "buyerpriceorange"      , "buyerpriceyellow",
+
+    "buyerbiddinginterval"   , "buyerbidsperinterval"
+};
+
 AHBConfig::AHBConfig()
 {
     Reset();
@@ -204,6 +242,11 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     SellMethod                     = conf->SellMethod;
     ConsiderOnlyBotAuctions        = conf->ConsiderOnlyBotAuctions;
     ItemsPerCycle                  = conf->ItemsPerCycle;
+    ListingsPerTransaction         = conf->ListingsPerTransaction;
+    SellerTimeBudget               = conf->SellerTimeBudget;
+    BuyerBestDeals                 = conf->BuyerBestDeals;
+    BuyerExpiryWindow              = conf->BuyerExpiryWindow;
+    SellerSleepTime                = conf->SellerSleepTime;
     Vendor_Items                   = conf->Vendor_Items;
     Loot_Items                     = conf->Loot_Items;
     Other_Items                    = conf->Other_Items;
@@ -259,23 +302,7 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     // Copy the sets
     //
 
-    NpcItems.clear();
-    for (uint32 id: conf->NpcItems)
-    {
-        NpcItems.insert(id);
-    }
-
-    LootItems.clear();
-    for (uint32 id: conf->LootItems)
-    {
-        LootItems.insert(id);
-    }
-
-    DisableItemStore.clear();
-    for (uint32 id: conf->DisableItemStore)
-    {
-        DisableItemStore.insert(id);
-    }
+    ItemSources = conf->ItemSources;
 
     SellerWhiteList.clear();
     for (uint32 id: conf->SellerWhiteList)
@@ -283,94 +310,25 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
         SellerWhiteList.insert(id);
     }
 
-    GreyTradeGoodsBin.clear();
-    for (uint32 id: conf->GreyTradeGoodsBin)
-    {
-        GreyTradeGoodsBin.insert(id);
-    }
-
-    WhiteTradeGoodsBin.clear();
-    for (uint32 id: conf->WhiteTradeGoodsBin)
-    {
-        WhiteTradeGoodsBin.insert(id);
-    }
-
-    GreenTradeGoodsBin.clear();
-    for (uint32 id: conf->GreenTradeGoodsBin)
-    {
-        GreenTradeGoodsBin.insert(id);
-    }
-
-    BlueTradeGoodsBin.clear();
-    for (uint32 id: conf->BlueTradeGoodsBin)
-    {
-        BlueTradeGoodsBin.insert(id);
-    }
-
-    PurpleTradeGoodsBin.clear();
-    for (uint32 id: conf->PurpleTradeGoodsBin)
-    {
-        PurpleTradeGoodsBin.insert(id);
-    }
-
-    OrangeTradeGoodsBin.clear();
-    for (uint32 id: conf->OrangeTradeGoodsBin)
-    {
-        OrangeTradeGoodsBin.insert(id);
-    }
-
-    YellowTradeGoodsBin.clear();
-    for (uint32 id: conf->YellowTradeGoodsBin)
-    {
-        YellowTradeGoodsBin.insert(id);
-    }
-
-
     //
-    // Bins for items
+    // Copy the bins
     //
 
-    GreyItemsBin.clear();
-    for (uint32 id: conf->GreyItemsBin)
-    {
-        GreyItemsBin.insert(id);
-    }
-
-    WhiteItemsBin.clear();
-    for (uint32 id: conf->WhiteItemsBin)
-    {
-        WhiteItemsBin.insert(id);
-    }
-
-    GreenItemsBin.clear();
-    for (uint32 id: conf->GreenItemsBin)
-    {
-        GreenItemsBin.insert(id);
-    }
-
-    BlueItemsBin.clear();
-    for (uint32 id: conf->BlueItemsBin)
-    {
-        BlueItemsBin.insert(id);
-    }
-
-    PurpleItemsBin.clear();
-    for (uint32 id: conf->PurpleItemsBin)
-    {
-        PurpleItemsBin.insert(id);
-    }
-
-    OrangeItemsBin.clear();
-    for (uint32 id: conf->OrangeItemsBin)
-    {
-        OrangeItemsBin.insert(id);
-    }
-
-    YellowItemsBin.clear();
-    for (uint32 id: conf->YellowItemsBin)
-    {
-        YellowItemsBin.insert(id);
-    }
+    GreyTradeGoodsBin   = conf->GreyTradeGoodsBin;
+    WhiteTradeGoodsBin  = conf->WhiteTradeGoodsBin;
+    GreenTradeGoodsBin  = conf->GreenTradeGoodsBin;
+    BlueTradeGoodsBin   = conf->BlueTradeGoodsBin;
+    PurpleTradeGoodsBin = conf->PurpleTradeGoodsBin;
+    OrangeTradeGoodsBin = conf->OrangeTradeGoodsBin;
+    YellowTradeGoodsBin = conf->YellowTradeGoodsBin;
+
+    GreyItemsBin        = conf->GreyItemsBin;
+    WhiteItemsBin       = conf->WhiteItemsBin;
+    GreenItemsBin       = conf->GreenItemsBin;
+    BlueItemsBin        = conf->BlueItemsBin;
+    PurpleItemsBin      = conf->PurpleItemsBin;
+    OrangeItemsBin      = conf->OrangeItemsBin;
+    YellowItemsBin      = conf->YellowItemsBin;
 }
 
 AHBConfig::~AHBConfig()
@@ -490,6 +448,10 @@ void AHBConfig::Reset()
     orangeItems                    = 0;
     yellowItems                    = 0;
 
+    buyerDealsDirty                = true;
+
+    sellersWakeUps                 = 0;
+
     //
     // Public properties
     //
@@ -511,6 +473,11 @@ void AHBConfig::Reset()
     SellAtMarketPrice              = false;
     ConsiderOnlyBotAuctions        = false;
     ItemsPerCycle                  = 200;
+    ListingsPerTransaction         = 0;
+    SellerTimeBudget               = 0;
+    BuyerBestDeals                 = false;
+    BuyerExpiryWindow              = 0;
+    SellerSleepTime                = 0;
 
     Vendor_Items                   = false;
     Loot_Items                     = true;
@@ -571,10 +538,9 @@ void AHBConfig::Reset()
     // Sets
     //
 
-    NpcItems.clear();
-    LootItems.clear();
+    ItemSources = std::make_shared<AHBItemSources>();
+    binsHash    = 0;
 
-    DisableItemStore.clear();
     SellerWhiteList.clear();
 
     GreyTradeGoodsBin.clear();
@@ -603,6 +569,11 @@ uint32 AHBConfig::GetAHID()
     return AHID;
 }
 
+uint64 AHBConfig::GetBinsHash()
+{
+    return binsHash;
+}
+
 uint32 AHBConfig::GetAHFID()
 {
     return AHFID;
@@ -611,6 +582,8 @@ uint32 AHBConfig::GetAHFID()
 void AHBConfig::SetMinItems(uint32 value)
 {
     minItems = value;
+
+    WakeSellers();
 }
 
 uint32 AHBConfig::GetMinItems()
@@ -634,6 +607,8 @@ void AHBConfig::SetMaxItems(uint32 value)
     maxItems = value;
     // CalculatePercents() needs to be called, but only if
     // SetPercentages() has been called at least once already.
+
+    WakeSellers();
 }
 
 uint32 AHBConfig::GetMaxItems()
@@ -1508,6 +1483,12 @@ void AHBConfig::SetBuyerPrice(uint32 color, uint32 value)
     default:
         break;
     }
+
+    //
+    // The reference prices of the ranked deals changed
+    //
+
+    buyerDealsDirty = true;
 }
 
 uint32 AHBConfig::GetBuyerPrice(uint32 color)
@@ -1677,6 +1658,60 @@ uint32 AHBConfig::GetMaximum(uint32 color)
     }
 }
 
+std::vector<AHBListing> const& AHBConfig::GetBin(uint32 color)
+{
+    switch (color)
+    {
+    case AHB_GREY_TG:
+        return GreyTradeGoodsBin;
+
+    case AHB_WHITE_TG:
+        return WhiteTradeGoodsBin;
+
+    case AHB_GREEN_TG:
+        return GreenTradeGoodsBin;
+
+    case AHB_BLUE_TG:
+        return BlueTradeGoodsBin;
+
+    case AHB_PURPLE_TG:
+        return PurpleTradeGoodsBin;
+
+    case AHB_ORANGE_TG:
+        return OrangeTradeGoodsBin;
+
+    case AHB_YELLOW_TG:
+        return YellowTradeGoodsBin;
+
+    case AHB_GREY_I:
+        return GreyItemsBin;
+
+    case AHB_WHITE_I:
+        return WhiteItemsBin;
+
+    case AHB_GREEN_I:
+        return GreenItemsBin;
+
+    case AHB_BLUE_I:
+        return BlueItemsBin;
+
+    case AHB_PURPLE_I:
+        return PurpleItemsBin;
+
+    case AHB_ORANGE_I:
+        return OrangeItemsBin;
+
+    case AHB_YELLOW_I:
+        return YellowItemsBin;
+
+    default:
+    {
+        static std::vector<AHBListing> const emptyBin;
+        return emptyBin;
+    }
+    }
+}
+
 void AHBConfig::DecItemCounts(uint32 Class, uint32 Quality)
 {
     switch (Class)
@@ -1852,6 +1887,21 @@ void AHBConfig::ResetItemCounts()
     purpleItems  = 0;
     orangeItems  = 0;
     yellowItems  = 0;
+
+    botItemsCount.clear();
+    botAuctionsCount.clear();
+
+    buyerCandidates.clear();
+    buyerCandidatesPos.clear();
+
+    buyerDeals.clear();
+    buyerDealsRatio.clear();
+    buyerDealsDirty = true;
+
+    sellerExpiries.Clear();
+    buyerExpiries.Clear();
+
+    sellersDormant.clear();
 }
 
 uint32 AHBConfig::TotalItemCounts()
@@ -1940,1391 +1990,1288 @@ uint32 AHBConfig::GetItemCounts(uint32 color)
     }
 }
 
-void AHBConfig::SetBidsPerInterval(uint32 value)
+void AHBConfig::IncBotItemCounts(uint32 botId, uint32 itemId)
 {
-    buyerBidsPerInterval = value;
+    ++botItemsCount[(uint64(botId) << 32) | itemId];
 }
 
-uint32 AHBConfig::GetBidsPerInterval()
+void AHBConfig::DecBotItemCounts(uint32 botId, uint32 itemId)
 {
-    return buyerBidsPerInterval;
-}
+    std::unordered_map<uint64, uint32>::iterator it = botItemsCount.find((uint64(botId) << 32) | itemId);
 
-void AHBConfig::UpdateItemStats(uint32 id, uint32 stackSize, uint64 buyout)
-{
-    if (!stackSize)
+    if (it == botItemsCount.end())
     {
         return;
     }
 
-    // 
-    // Collects information about the item bought
-    //
+    if (--it->second == 0)
+    {
+        botItemsCount.erase(it);
+    }
+}
 
-    uint32 perUnit = buyout / stackSize;
+uint32 AHBConfig::GetBotItemCounts(uint32 botId, uint32 itemId)
+{
+    std::unordered_map<uint64, uint32>::const_iterator it = botItemsCount.find((uint64(botId) << 32) | itemId);
 
-    if (itemsCount.count(id) == 0)
+    if (it == botItemsCount.end())
     {
-        itemsCount[id] = 1;
-        itemsSum[id]   = perUnit;
-        itemsPrice[id] = perUnit;
+        return 0;
     }
-    else
-    {
-        itemsCount[id]++;
 
-        //
-        // Reset the statistics to force adapt to the market price.
-        // Adds a little of randomness by adding/removing a range of 9 to the threshold.
-        //
+    return it->second;
+}
 
-        if (itemsCount[id] > MarketResetThreshold + (urand(1, 19) - 10))
-        {
-            itemsCount[id] = 1;
-            itemsSum[id]   = perUnit;
-            itemsPrice[id] = perUnit;
-        }
-        else
-        {
-            //
-            // Here is decided the price for single unit:
-            // right now is a plain, boring average of the ~100 previous auctions.
-            //
+void AHBConfig::IncBotAuctionCounts(uint32 botId)
+{
+    ++botAuctionsCount[botId];
+}
 
-            itemsSum[id]   = (itemsSum[id] + perUnit);
-            itemsPrice[id] = itemsSum[id] / itemsCount[id];
-        }
+void AHBConfig::DecBotAuctionCounts(uint32 botId)
+{
+    std::unordered_map<uint32, uint32>::iterator it = botAuctionsCount.find(botId);
+
+    if (it == botAuctionsCount.end())
+    {
+        return;
     }
 
-    if (DebugOutConfig)
+    if (--it->second == 0)
     {
-        LOG_INFO("module", "Updating market price item={}, price={}", id, itemsPrice[id]);
+        botAuctionsCount.erase(it);
     }
 }
 
-uint64 AHBConfig::GetItemPrice(uint32 id)
+uint32 AHBConfig::GetBotAuctionCounts(uint32 botId)
 {
-    if (itemsCount.count(id) != 0)
+    std::unordered_map<uint32, uint32>::const_iterator it = botAuctionsCount.find(botId);
+
+    if (it == botAuctionsCount.end())
     {
-        return itemsPrice[id];
+        return 0;
     }
 
-    return 0;
+    return it->second;
 }
 
-void AHBConfig::Initialize(std::set<uint32> botsIds)
+void AHBConfig::AddBuyerCandidate(AuctionEntry* auction)
 {
-    InitializeFromFile();
-    InitializeFromSql(botsIds);
-    InitializeBins();
+    if (buyerCandidatesPos.find(auction->Id) != buyerCandidatesPos.end())
+    {
+        return;
+    }
+
+    buyerCandidatesPos[auction->Id] = buyerCandidates.size();
+    buyerCandidates.push_back(auction->Id);
+
+    buyerExpiries.Add(auction->Id, auction->expire_time);
+
+    if (BuyerBestDeals && !buyerDealsDirty)
+    {
+        rankBuyerDeal(auction);
+    }
 }
 
-void AHBConfig::InitializeFromFile()
+void AHBConfig::RemoveBuyerCandidate(uint32 auctionId)
 {
+    std::unordered_map<uint32, uint32>::iterator it = buyerCandidatesPos.find(auctionId);
+
+    if (it == buyerCandidatesPos.end())
+    {
+        return;
+    }
+
     //
-    // Load from, the configuration file
+    // Move the last candidate in the hole, so that the array stays dense
     //
 
-    DebugOut                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG"        , false);
-    DebugOutConfig                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_CONFIG" , false);
-    DebugOutFilters                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_FILTERS", false);
-    DebugOutBuyer                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_BUYER"  , false);
-    DebugOutSeller                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_SELLER" , false);
+    uint32 pos  = it->second;
+    uint32 last = buyerCandidates.back();
 
-    TraceSeller                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_SELLER" , false);
-    TraceBuyer                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_BUYER"  , false);
+    buyerCandidates[pos]     = last;
+    buyerCandidatesPos[last] = pos;
 
-    AHBSeller                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableSeller"           , false);
-    AHBBuyer                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableBuyer"            , false);
-    SellMethod                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForSeller"   , false);
-    BuyMethod                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForBuyer"    , false);
-    SellAtMarketPrice              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseMarketPriceForSeller", false);
-    MarketResetThreshold           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketResetThreshold"   , 25);
-    DuplicatesCount                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 0);
-    DivisibleStacks                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DivisibleStacks"        , false);
-    ElapsingTimeClass              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 1);
-    ConsiderOnlyBotAuctions        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.ConsiderOnlyBotAuctions", false);
-    ItemsPerCycle                  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle"          , 200);
+    buyerCandidates.pop_back();
+    buyerCandidatesPos.erase(auctionId);
 
-    //
-    // Flags: item types
-    //
+    unrankBuyerDeal(auctionId);
 
-    Vendor_Items                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorItems"      , false);
-    Loot_Items                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootItems"        , true);
-    Other_Items                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherItems"       , false);
-    Vendor_TGs                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorTradeGoods" , false);
-    Loot_TGs                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootTradeGoods"   , true);
-    Other_TGs                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherTradeGoods"  , false);
+    buyerExpiries.Remove(auctionId);
+}
 
+void AHBConfig::UpdateBuyerCandidate(AuctionEntry* auction)
+{
     //
-    // Flags: items binding
+    // A bid raised the price: move the auction down the ranking, or out of it
     //
 
-    No_Bind                        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.No_Bind"             , true);
-    Bind_When_Picked_Up            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Picked_Up" , false);
-    Bind_When_Equipped             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Equipped"  , true);
-    Bind_When_Use                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Use"       , true);
-    Bind_Quest_Item                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_Quest_Item"     , false);
+    if (!BuyerBestDeals || buyerDealsDirty)
+    {
+        return;
+    }
 
-    //
-    // Flags: misc
-    //
+    unrankBuyerDeal(auction->Id);
+    rankBuyerDeal  (auction);
+}
 
-    DisableConjured                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableConjured"               , false);
-    DisableGems                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableGems"                   , false);
-    DisableMoney                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoney"                  , false);
-    DisableMoneyLoot               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoneyLoot"              , false);
-    DisableLootable                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableLootable"               , false);
-    DisableKeys                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableKeys"                   , false);
-    DisableDuration                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDuration"               , false);
-    DisableBOP_Or_Quest_NoReqLevel = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableBOP_Or_Quest_NoReqLevel", false);
+void AHBConfig::SampleBuyerCandidates(uint32 count, ObjectGuid bidder, std::vector<uint32>& picks)
+{
+    picks.clear();
+
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(GetAHFID());
 
     //
-    // Flags: items per class
+    // Partial Fisher-Yates: the first slots of the array are shuffled in place, each draw costs O(1)
+    // and no auction can be drawn twice.
+    // The auctions where the bot is already the highest bidder are moved past the end of the window
+    // and the slot is drawn again, so that every pick is an auction the bot can bid on.
     //
 
-    DisableWarriorItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarriorItems"    , false);
-    DisablePaladinItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePaladinItems"    , false);
-    DisableHunterItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableHunterItems"     , false);
-    DisableRogueItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableRogueItems"      , false);
-    DisablePriestItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePriestItems"     , false);
-    DisableDKItems                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDKItems"         , false);
-    DisableShamanItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableShamanItems"     , false);
-    DisableMageItems               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMageItems"       , false);
-    DisableWarlockItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarlockItems"    , false);
-    DisableUnusedClassItems        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableUnusedClassItems", false);
-    DisableDruidItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDruidItems"      , false);
+    uint32 size = buyerCandidates.size();
+    uint32 slot = 0;
 
-    //
-    // Items level and skills
-    //
+    while (slot < count && slot < size)
+    {
+        swapBuyerCandidates(slot, urand(slot, size - 1));
 
-    DisableItemsBelowLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowLevel"       , 0);
-    DisableItemsAboveLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveLevel"       , 0);
-    DisableItemsBelowGUID          = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowGUID"        , 0);
-    DisableItemsAboveGUID          = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveGUID"        , 0);
-    DisableItemsBelowReqLevel      = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowReqLevel"    , 0);
-    DisableItemsAboveReqLevel      = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveReqLevel"    , 0);
-    DisableItemsBelowReqSkillRank  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowReqSkillRank", 0);
-    DisableItemsAboveReqSkillRank  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveReqSkillRank", 0);
+        AuctionEntry* auction = auctionHouse->GetAuction(buyerCandidates[slot]);
 
-    //
-    // Trade goods level and skills
-    //
+        if (!auction || auction->bidder == bidder)
+        {
+            swapBuyerCandidates(slot, --size);
+            continue;
+        }
 
-    DisableTGsBelowLevel           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowLevel"       , 0);
-    DisableTGsAboveLevel           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveLevel"       , 0);
-    DisableTGsBelowGUID            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowGUID"        , 0);
-    DisableTGsAboveGUID            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveGUID"        , 0);
-    DisableTGsBelowReqLevel        = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowReqLevel"    , 0);
-    DisableTGsAboveReqLevel        = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveReqLevel"    , 0);
-    DisableTGsBelowReqSkillRank    = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowReqSkillRank", 0);
-    DisableTGsAboveReqSkillRank    = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveReqSkillRank", 0);
+        picks.push_back(buyerCandidates[slot]);
+        slot++;
+    }
+}
 
-    //
-    // Whitelists
-    //
+void AHBConfig::swapBuyerCandidates(uint32 i, uint32 j)
+{
+    if (i == j)
+    {
+        return;
+    }
 
-    SellerWhiteList                = getCommaSeparatedIntegers(sConfigMgr->GetOption<std::string>("AuctionHouseBot.SellerWhiteList", ""));
+    std::swap(buyerCandidates[i], buyerCandidates[j]);
+
+    buyerCandidatesPos[buyerCandidates[i]] = i;
+    buyerCandidatesPos[buyerCandidates[j]] = j;
 }
 
-void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
+void AHBConfig::SelectBuyerDeals(uint32 count, ObjectGuid bidder, std::vector<uint32>& picks)
 {
+    picks.clear();
+
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(GetAHFID());
+
     //
-    // Load min and max items
+    // The ranking is built again from the candidates when the buyer prices changed
     //
 
-    SetMinItems(WorldDatabase.Query("SELECT minitems FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxItems(WorldDatabase.Query("SELECT maxitems FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    if (buyerDealsDirty)
+    {
+        buyerDeals.clear();
+        buyerDealsRatio.clear();
+
+        for (uint32 auctionId: buyerCandidates)
+        {
+            AuctionEntry* auction = auctionHouse->GetAuction(auctionId);
+
+            if (auction)
+            {
+                rankBuyerDeal(auction);
+            }
+        }
+
+        buyerDealsDirty = false;
+    }
 
     //
-    // Load percentages
+    // Walk the ranking from the best deal. The players bids are not notified, so the ratio of each
+    // auction is checked again and the ones that became more expensive are moved down the ranking.
     //
 
-    uint32 greytg   = WorldDatabase.Query("SELECT percentgreytradegoods   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 whitetg  = WorldDatabase.Query("SELECT percentwhitetradegoods  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 greentg  = WorldDatabase.Query("SELECT percentgreentradegoods  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 bluetg   = WorldDatabase.Query("SELECT percentbluetradegoods   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 purpletg = WorldDatabase.Query("SELECT percentpurpletradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 orangetg = WorldDatabase.Query("SELECT percentorangetradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 yellowtg = WorldDatabase.Query("SELECT percentyellowtradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
+    std::set<std::pair<double, uint32>>::iterator it = buyerDeals.begin();
 
-    uint32 greyi    = WorldDatabase.Query("SELECT percentgreyitems        FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 whitei   = WorldDatabase.Query("SELECT percentwhiteitems       FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 greeni   = WorldDatabase.Query("SELECT percentgreenitems       FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 bluei    = WorldDatabase.Query("SELECT percentblueitems        FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 purplei  = WorldDatabase.Query("SELECT percentpurpleitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 orangei  = WorldDatabase.Query("SELECT percentorangeitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 yellowi  = WorldDatabase.Query("SELECT percentyellowitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
+    uint32 visited = 0;
 
-    SetPercentages(greytg, whitetg, greentg, bluetg, purpletg, orangetg, yellowtg, greyi, whitei, greeni, bluei, purplei, orangei, yellowi);
+    while (it != buyerDeals.end() && picks.size() < count && visited < count * AUCTION_HOUSE_BOT_LOOP_BREAKER)
+    {
+        visited++;
 
-    // 
-    // Load min and max prices
-    // 
+        uint32        auctionId = it->second;
+        double        ranked    = it->first;
+        AuctionEntry* auction   = auctionHouse->GetAuction(auctionId);
+        double        ratio;
 
-    SetMinPrice(AHB_GREY  , WorldDatabase.Query("SELECT minpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_GREY  , WorldDatabase.Query("SELECT maxpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_WHITE , WorldDatabase.Query("SELECT minpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_WHITE , WorldDatabase.Query("SELECT maxpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_GREEN , WorldDatabase.Query("SELECT minpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_GREEN , WorldDatabase.Query("SELECT maxpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_BLUE  , WorldDatabase.Query("SELECT minpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_BLUE  , WorldDatabase.Query("SELECT maxpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_PURPLE, WorldDatabase.Query("SELECT minpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_PURPLE, WorldDatabase.Query("SELECT maxpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_ORANGE, WorldDatabase.Query("SELECT minpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_ORANGE, WorldDatabase.Query("SELECT maxpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_YELLOW, WorldDatabase.Query("SELECT minpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_YELLOW, WorldDatabase.Query("SELECT maxpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+        if (!auction || !getBuyerDealRatio(auction, ratio))
+        {
+            it = buyerDeals.erase(it);
+            buyerDealsRatio.erase(auctionId);
 
-    // 
-    // Load min and max bid prices
-    // 
+            continue;
+        }
 
-    SetMinBidPrice(AHB_GREY  , WorldDatabase.Query("SELECT minbidpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_GREY  , WorldDatabase.Query("SELECT maxbidpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_WHITE , WorldDatabase.Query("SELECT minbidpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_WHITE , WorldDatabase.Query("SELECT maxbidpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_GREEN , WorldDatabase.Query("SELECT minbidpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_GREEN , WorldDatabase.Query("SELECT maxbidpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_BLUE  , WorldDatabase.Query("SELECT minbidpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_BLUE  , WorldDatabase.Query("SELECT maxbidpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_PURPLE, WorldDatabase.Query("SELECT minbidpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_PURPLE, WorldDatabase.Query("SELECT maxbidpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_ORANGE, WorldDatabase.Query("SELECT minbidpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_ORANGE, WorldDatabase.Query("SELECT maxbidpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_YELLOW, WorldDatabase.Query("SELECT minbidpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_YELLOW, WorldDatabase.Query("SELECT maxbidpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+        if (ratio != ranked)
+        {
+            it = buyerDeals.erase(it);
 
-    // 
-    // Load max stacks
-    // 
+            buyerDeals.insert(std::make_pair(ratio, auctionId));
+            buyerDealsRatio[auctionId] = ratio;
 
-    SetMaxStack(AHB_GREY  , WorldDatabase.Query("SELECT maxstackgrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_WHITE , WorldDatabase.Query("SELECT maxstackwhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_GREEN , WorldDatabase.Query("SELECT maxstackgreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_BLUE  , WorldDatabase.Query("SELECT maxstackblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_PURPLE, WorldDatabase.Query("SELECT maxstackpurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_ORANGE, WorldDatabase.Query("SELECT maxstackorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_YELLOW, WorldDatabase.Query("SELECT maxstackyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+            continue;
+        }
 
-    if (DebugOutConfig)
-    {
-        LOG_INFO("module", "Settings for Auctionhouse {}", GetAHID());
+        ++it;
 
-        LOG_INFO("module", "minItems                = {}", GetMinItems());
-        LOG_INFO("module", "maxItems                = {}", GetMaxItems());
+        //
+        // Do not bid again on the auctions where the bot is already the highest bidder
+        //
 
-        LOG_INFO("module", "percentGreyTradeGoods   = {}", GetPercentages(AHB_GREY_TG));
-        LOG_INFO("module", "percentWhiteTradeGoods  = {}", GetPercentages(AHB_WHITE_TG));
-        LOG_INFO("module", "percentGreenTradeGoods  = {}", GetPercentages(AHB_GREEN_TG));
-        LOG_INFO("module", "percentBlueTradeGoods   = {}", GetPercentages(AHB_BLUE_TG));
-        LOG_INFO("module", "percentPurpleTradeGoods = {}", GetPercentages(AHB_PURPLE_TG));
-        LOG_INFO("module", "percentOrangeTradeGoods = {}", GetPercentages(AHB_ORANGE_TG));
-        LOG_INFO("module", "percentYellowTradeGoods = {}", GetPercentages(AHB_YELLOW_TG));
-        LOG_INFO("module", "percentGreyItems        = {}", GetPercentages(AHB_GREY_I));
-        LOG_INFO("module", "percentWhiteItems       = {}", GetPercentages(AHB_WHITE_I));
-        LOG_INFO("module", "percentGreenItems       = {}", GetPercentages(AHB_GREEN_I));
-        LOG_INFO("module", "percentBlueItems        = {}", GetPercentages(AHB_BLUE_I));
-        LOG_INFO("module", "percentPurpleItems      = {}", GetPercentages(AHB_PURPLE_I));
-        LOG_INFO("module", "percentOrangeItems      = {}", GetPercentages(AHB_ORANGE_I));
-        LOG_INFO("module", "percentYellowItems      = {}", GetPercentages(AHB_YELLOW_I));
+        if (auction->bidder == bidder)
+        {
+            continue;
+        }
 
-        LOG_INFO("module", "minPriceGrey            = {}", GetMinPrice(AHB_GREY));
-        LOG_INFO("module", "maxPriceGrey            = {}", GetMaxPrice(AHB_GREY));
-        LOG_INFO("module", "minPriceWhite           = {}", GetMinPrice(AHB_WHITE));
-        LOG_INFO("module", "maxPriceWhite           = {}", GetMaxPrice(AHB_WHITE));
-        LOG_INFO("module", "minPriceGreen           = {}", GetMinPrice(AHB_GREEN));
-        LOG_INFO("module", "maxPriceGreen           = {}", GetMaxPrice(AHB_GREEN));
-        LOG_INFO("module", "minPriceBlue            = {}", GetMinPrice(AHB_BLUE));
-        LOG_INFO("module", "maxPriceBlue            = {}", GetMaxPrice(AHB_BLUE));
-        LOG_INFO("module", "minPricePurple          = {}", GetMinPrice(AHB_PURPLE));
-        LOG_INFO("module", "maxPricePurple          = {}", GetMaxPrice(AHB_PURPLE));
-        LOG_INFO("module", "minPriceOrange          = {}", GetMinPrice(AHB_ORANGE));
-        LOG_INFO("module", "maxPriceOrange          = {}", GetMaxPrice(AHB_ORANGE));
-        LOG_INFO("module", "minPriceYellow          = {}", GetMinPrice(AHB_YELLOW));
-        LOG_INFO("module", "maxPriceYellow          = {}", GetMaxPrice(AHB_YELLOW));
+        picks.push_back(auctionId);
+    }
+}
 
-        LOG_INFO("module", "minBidPriceGrey         = {}", GetMinBidPrice(AHB_GREY));
-        LOG_INFO("module", "maxBidPriceGrey         = {}", GetMaxBidPrice(AHB_GREY));
-        LOG_INFO("module", "minBidPriceWhite        = {}", GetMinBidPrice(AHB_WHITE));
-        LOG_INFO("module", "maxBidPriceWhite        = {}", GetMaxBidPrice(AHB_WHITE));
-        LOG_INFO("module", "minBidPriceGreen        = {}", GetMinBidPrice(AHB_GREEN));
-        LOG_INFO("module", "maxBidPriceGreen        = {}", GetMaxBidPrice(AHB_GREEN));
-        LOG_INFO("module", "minBidPriceBlue         = {}", GetMinBidPrice(AHB_BLUE));
-        LOG_INFO("module", "maxBidPriceBlue         = {}", GetMinBidPrice(AHB_BLUE));
-        LOG_INFO("module", "minBidPricePurple       = {}", GetMinBidPrice(AHB_PURPLE));
-        LOG_INFO("module", "maxBidPricePurple       = {}", GetMaxBidPrice(AHB_PURPLE));
-        LOG_INFO("module", "minBidPriceOrange       = {}", GetMinBidPrice(AHB_ORANGE));
-        LOG_INFO("module", "maxBidPriceOrange       = {}", GetMaxBidPrice(AHB_ORANGE));
-        LOG_INFO("module", "minBidPriceYellow       = {}", GetMinBidPrice(AHB_YELLOW));
-        LOG_INFO("module", "maxBidPriceYellow       = {}", GetMaxBidPrice(AHB_YELLOW));
+void AHBConfig::SelectBuyerExpiries(uint32 count, ObjectGuid bidder, std::vector<uint32>& picks)
+{
+    picks.clear();
 
-        LOG_INFO("module", "maxStackGrey            = {}", GetMaxStack(AHB_GREY));
-        LOG_INFO("module", "maxStackWhite           = {}", GetMaxStack(AHB_WHITE));
-        LOG_INFO("module", "maxStackGreen           = {}", GetMaxStack(AHB_GREEN));
-        LOG_INFO("module", "maxStackBlue            = {}", GetMaxStack(AHB_BLUE));
-        LOG_INFO("module", "maxStackPurple          = {}", GetMaxStack(AHB_PURPLE));
-        LOG_INFO("module", "maxStackOrange          = {}", GetMaxStack(AHB_ORANGE));
-        LOG_INFO("module", "maxStackYellow          = {}", GetMaxStack(AHB_YELLOW));
+    if (BuyerExpiryWindow == 0)
+    {
+        return;
     }
 
     //
-    // Reset the situation of the auction house
+    // The auctions about to expire, the soonest first
     //
 
-    ResetItemCounts();
-
-    //
-    // Update the situation of the auction house
-    //
+    std::vector<uint32> expiring;
+    buyerExpiries.Collect(time(NULL) + BuyerExpiryWindow * MINUTE, expiring);
 
     AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(GetAHFID());
-    uint32              auctions     = auctionHouse->Getcount();
 
-    if (auctions)
+    for (uint32 auctionId: expiring)
     {
-        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+        if (picks.size() >= count)
         {
-            AuctionEntry* Aentry = itr->second;
-            Item*         item   = sAuctionMgr->GetAItem(Aentry->item_guid);
+            break;
+        }
 
-            //
-            // If it has to only consider the bots auctions, skip the ones belonging to the players
-            //
+        AuctionEntry* auction = auctionHouse->GetAuction(auctionId);
 
-            if (ConsiderOnlyBotAuctions)
-            {
-                if (botsIds.find(Aentry->owner.GetCounter()) == botsIds.end())
-                {
-                    continue;
-                }
-            }
+        if (!auction || auction->bidder == bidder)
+        {
+            continue;
+        }
 
-            if (item)
-            {
-                ItemTemplate const* prototype = item->GetTemplate();
+        picks.push_back(auctionId);
+    }
+}
 
-                if (prototype)
-                {
-                    switch (prototype->Quality)
-                    {
-                    case AHB_GREY:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_GREY_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_GREY_I);
-                        }
-                        break;
+void AHBConfig::AddSellerExpiry(AuctionEntry* auction)
+{
+    sellerExpiries.Add(auction->Id, auction->expire_time);
+}
 
-                    case AHB_WHITE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_WHITE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_WHITE_I);
-                        }
+void AHBConfig::RemoveSellerExpiry(uint32 auctionId)
+{
+    sellerExpiries.Remove(auctionId);
+}
 
-                        break;
+uint32 AHBConfig::CountSellerExpiries(time_t until)
+{
+    return sellerExpiries.Count(until);
+}
 
-                    case AHB_GREEN:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_GREEN_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_GREEN_I);
-                        }
+void AHBConfig::SleepSeller(uint32 botId)
+{
+    if (SellerSleepTime == 0)
+    {
+        return;
+    }
 
-                        break;
+    sellersDormant[botId] = std::make_pair(sellersWakeUps, time(NULL));
+}
 
-                    case AHB_BLUE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_BLUE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_BLUE_I);
-                        }
+bool AHBConfig::IsSellerDormant(uint32 botId)
+{
+    std::unordered_map<uint32, std::pair<uint32, time_t>>::iterator it = sellersDormant.find(botId);
 
-                        break;
+    if (it == sellersDormant.end())
+    {
+        return false;
+    }
 
-                    case AHB_PURPLE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_PURPLE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_PURPLE_I);
-                        }
+    //
+    // Woken up by a market event, by the timer, or by one of the listings of the bots which lapsed
+    //
 
-                        break;
+    time_t now = time(NULL);
 
-                    case AHB_ORANGE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_ORANGE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_ORANGE_I);
-                        }
+    if (it->second.first != sellersWakeUps || now - it->second.second >= time_t(SellerSleepTime) || CountSellerExpiries(now) > 0)
+    {
+        sellersDormant.erase(it);
+        return false;
+    }
 
-                        break;
+    return true;
+}
 
-                    case AHB_YELLOW:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_YELLOW_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_YELLOW_I);
-                        }
+void AHBConfig::WakeSellers()
+{
+    sellersWakeUps++;
+}
 
-                        break;
-                    }
-                }
-            }
-        }
-    }
+bool AHBConfig::getBuyerDealRatio(AuctionEntry* auction, double& ratio)
+{
+    ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(auction->item_template);
 
-    if (DebugOutConfig)
+    if (!prototype || prototype->Quality > AHB_MAX_QUALITY)
     {
-        LOG_INFO("module", "Current situation for the auctionhouse {}", GetAHID());
-        LOG_INFO("module", "    Grey   Trade Goods {}", GetItemCounts(AHB_GREY_TG));
-        LOG_INFO("module", "    White  Trade Goods {}", GetItemCounts(AHB_WHITE_TG));
-        LOG_INFO("module", "    Green  Trade Goods {}", GetItemCounts(AHB_GREEN_TG));
-        LOG_INFO("module", "    Blue   Trade Goods {}", GetItemCounts(AHB_BLUE_TG));
-        LOG_INFO("module", "    Purple Trade Goods {}", GetItemCounts(AHB_PURPLE_TG));
-        LOG_INFO("module", "    Orange Trade Goods {}", GetItemCounts(AHB_ORANGE_TG));
-        LOG_INFO("module", "    Yellow Trade Goods {}", GetItemCounts(AHB_YELLOW_TG));
-        LOG_INFO("module", "    Grey   Items       {}", GetItemCounts(AHB_GREY_I));
-        LOG_INFO("module", "    White  Items       {}", GetItemCounts(AHB_WHITE_I));
-        LOG_INFO("module", "    Green  Items       {}", GetItemCounts(AHB_GREEN_I));
-        LOG_INFO("module", "    Blue   Items       {}", GetItemCounts(AHB_BLUE_I));
-        LOG_INFO("module", "    Purple Items       {}", GetItemCounts(AHB_PURPLE_I));
-        LOG_INFO("module", "    Orange Items       {}", GetItemCounts(AHB_ORANGE_I));
-        LOG_INFO("module", "    Yellow Items       {}", GetItemCounts(AHB_YELLOW_I));
+        return false;
     }
 
     //
-    // Auctions buyer
-    //
-
-    SetBuyerPrice(AHB_GREY  , WorldDatabase.Query("SELECT buyerpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_WHITE , WorldDatabase.Query("SELECT buyerpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_GREEN , WorldDatabase.Query("SELECT buyerpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_BLUE  , WorldDatabase.Query("SELECT buyerpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_PURPLE, WorldDatabase.Query("SELECT buyerpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_ORANGE, WorldDatabase.Query("SELECT buyerpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_YELLOW, WorldDatabase.Query("SELECT buyerpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-
-    //
-    // Load bidding interval
+    // Ammo is never bought
     //
 
-    SetBiddingInterval(WorldDatabase.Query("SELECT buyerbiddinginterval FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    if (prototype->Class == 6)
+    {
+        return false;
+    }
 
     //
-    // Load bids per interval
+    // Same reference price the buyer uses to decide its maximum bid
     //
 
-    SetBidsPerInterval(WorldDatabase.Query("SELECT buyerbidsperinterval FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    double reference = double(BuyMethod ? prototype->SellPrice : prototype->BuyPrice) * auction->itemCount * GetBuyerPrice(prototype->Quality);
 
-    if (DebugOutConfig)
+    if (reference <= 0)
     {
-        LOG_INFO("module", "Current Settings for Auctionhouse {} buyer", GetAHID());
-        LOG_INFO("module", "buyerPriceGrey          = {}", GetBuyerPrice(AHB_GREY));
-        LOG_INFO("module", "buyerPriceWhite         = {}", GetBuyerPrice(AHB_WHITE));
-        LOG_INFO("module", "buyerPriceGreen         = {}", GetBuyerPrice(AHB_GREEN));
-        LOG_INFO("module", "buyerPriceBlue          = {}", GetBuyerPrice(AHB_BLUE));
-        LOG_INFO("module", "buyerPricePurple        = {}", GetBuyerPrice(AHB_PURPLE));
-        LOG_INFO("module", "buyerPriceOrange        = {}", GetBuyerPrice(AHB_ORANGE));
-        LOG_INFO("module", "buyerPriceYellow        = {}", GetBuyerPrice(AHB_YELLOW));
-        LOG_INFO("module", "buyerBiddingInterval    = {}", GetBiddingInterval());
-        LOG_INFO("module", "buyerBidsPerInterval    = {}", GetBidsPerInterval());
+        return false;
     }
 
-    //
-    // Reload the list of disabled items
-    //
+    uint32 currentprice = auction->bid ? auction->bid : auction->startbid;
+
+    ratio = currentprice / reference;
 
-    DisableItemStore.clear();
+    return ratio < 1.0;
+}
 
-    QueryResult result = WorldDatabase.Query("SELECT item FROM mod_auctionhousebot_disabled_items");
+void AHBConfig::rankBuyerDeal(AuctionEntry* auction)
+{
+    double ratio;
 
-    if (result)
+    if (!getBuyerDealRatio(auction, ratio))
     {
-        do
-        {
-            Field* fields = result->Fetch();
-            DisableItemStore.insert(fields[0].Get<uint32>());
-        } while (result->NextRow());
+        return;
     }
 
-    if (DebugOutConfig)
+    buyerDeals.insert(std::make_pair(ratio, auction->Id));
+    buyerDealsRatio[auction->Id] = ratio;
+}
+
+void AHBConfig::unrankBuyerDeal(uint32 auctionId)
+{
+    std::unordered_map<uint32, double>::iterator it = buyerDealsRatio.find(auctionId);
+
+    if (it == buyerDealsRatio.end())
     {
-        LOG_INFO("module", "Loaded {} items from the disabled item store", uint32(DisableItemStore.size()));
+        return;
     }
 
-    // 
-    // Reload the list of npc items
-    // 
-
-    NpcItems.clear();
+    buyerDeals.erase(std::make_pair(it->second, auctionId));
+    buyerDealsRatio.erase(it);
+}
 
-    QueryResult npcResults = WorldDatabase.Query("SELECT distinct item FROM npc_vendor");
+std::vector<uint32> const& AHBConfig::GetBuyerCandidates()
+{
+    return buyerCandidates;
+}
 
-    if (npcResults)
-    {
-        do
-        {
-            Field* fields = npcResults->Fetch();
-            NpcItems.insert(fields[0].Get<int32>());
+void AHBConfig::SetBidsPerInterval(uint32 value)
+{
+    buyerBidsPerInterval = value;
+}
 
-        } while (npcResults->NextRow());
-    }
-    else
-    {
-        if (DebugOutConfig)
-        {
-            LOG_ERROR("module", "AuctionHouseBot: failed to retrieve npc items");
-        }
-    }
+uint32 AHBConfig::GetBidsPerInterval()
+{
+    return buyerBidsPerInterval;
+}
 
-    if (DebugOutConfig)
+void AHBConfig::UpdateItemStats(uint32 id, uint32 stackSize, uint64 buyout)
+{
+    if (!stackSize)
     {
-        LOG_INFO("module", "Loaded {} items from NPCs", uint32(NpcItems.size()));
+        return;
     }
 
     // 
-    // Reload the list from the lootable items
-    // 
-
-    LootItems.clear();
+    // Collects information about the item bought
+    //
 
-    QueryResult itemsResults = WorldDatabase.Query(
-        "SELECT item FROM creature_loot_template      UNION "
-        "SELECT item FROM reference_loot_template     UNION "
-        "SELECT item FROM disenchant_loot_template    UNION "
-        "SELECT item FROM fishing_loot_template       UNION "
-        "SELECT item FROM gameobject_loot_template    UNION "
-        "SELECT item FROM item_loot_template          UNION "
-        "SELECT item FROM milling_loot_template       UNION "
-        "SELECT item FROM pickpocketing_loot_template UNION "
-        "SELECT item FROM prospecting_loot_template   UNION "
-        "SELECT item FROM skinning_loot_template");
+    uint32 perUnit = buyout / stackSize;
 
-    if (itemsResults)
+    if (itemsCount.count(id) == 0)
     {
-        do
-        {
-            Field* fields = itemsResults->Fetch();
-            LootItems.insert(fields[0].Get<uint32>());
-
-        } while (itemsResults->NextRow());
+        itemsCount[id] = 1;
+        itemsSum[id]   = perUnit;
+        itemsPrice[id] = perUnit;
     }
     else
     {
-        if (DebugOutConfig)
+        itemsCount[id]++;
+
+        //
+        // Reset the statistics to force adapt to the market price.
+        // Adds a little of randomness by adding/removing a range of 9 to the threshold.
+        //
+
+        if (itemsCount[id] > MarketResetThreshold + (urand(1, 19) - 10))
         {
-            LOG_ERROR("module", "AuctionHouseBot: failed to retrieve loot items");
+            itemsCount[id] = 1;
+            itemsSum[id]   = perUnit;
+            itemsPrice[id] = perUnit;
+        }
+        else
+        {
+            //
+            // Here is decided the price for single unit:
+            // right now is a plain, boring average of the ~100 previous auctions.
+            //
+
+            itemsSum[id]   = (itemsSum[id] + perUnit);
+            itemsPrice[id] = itemsSum[id] / itemsCount[id];
         }
     }
 
     if (DebugOutConfig)
     {
-        LOG_INFO("module", "Loaded {} items from lootable items", uint32(LootItems.size()));
+        LOG_INFO("module", "Updating market price item={}, price={}", id, itemsPrice[id]);
     }
 }
 
-void AHBConfig::InitializeBins()
+uint64 AHBConfig::GetItemPrice(uint32 id)
 {
-    //
-    // Exclude items depending on the configuration; whatever passes all the tests is put in the lists.
-    //
-
-    ItemTemplateContainer const* its = sObjectMgr->GetItemTemplateStore();
-
-    for (ItemTemplateContainer::const_iterator itr = its->begin(); itr != its->end(); ++itr)
+    if (itemsCount.count(id) != 0)
     {
+        return itemsPrice[id];
+    }
 
-        //
-        // Exclude items with the blocked binding type
-        //
+    return 0;
+}
 
-        if (itr->second.Bonding == NO_BIND && !No_Bind)
-        {
-            continue;
-        }
+void AHBConfig::Initialize(std::set<uint32> botsIds, AHBHousesSettings const& houses, std::shared_ptr<AHBItemSources const> sources)
+{
+    InitializeFromFile();
+    InitializeFromSql(botsIds, houses, sources);
 
-        if (itr->second.Bonding == BIND_WHEN_PICKED_UP && !Bind_When_Picked_Up)
-        {
-            continue;
-        }
+    //
+    // The bins are built apart, see PrepareBins() and InitializeBins(), so that the auction houses can share the work
+    //
+}
 
-        if (itr->second.Bonding == BIND_WHEN_EQUIPPED && !Bind_When_Equipped)
-        {
-            continue;
-        }
+// =============================================================================
+// Read the settings of all the auction houses with a single query
+// =============================================================================
 
-        if (itr->second.Bonding == BIND_WHEN_USE && !Bind_When_Use)
-        {
-            continue;
-        }
+void AHBConfig::LoadHousesSettings(AHBHousesSettings& houses)
+{
+    houses.clear();
 
-        if (itr->second.Bonding == BIND_QUEST_ITEM && !Bind_Quest_Item)
-        {
-            continue;
-        }
+    uint32      columns = sizeof(AHBHouseColumns) / sizeof(AHBHouseColumns[0]);
+    std::string query   = "SELECT auctionhouse";
 
-        //
-        // Exclude items with no possible price
-        //
+    for (uint32 column = 0; column < columns; ++column)
+    {
+        query += ", ";
+        query += AHBHouseColumns[column];
+    }
 
-        if (SellMethod)
-        {
-            if (itr->second.BuyPrice == 0)
-            {
-                continue;
-            }
-        }
-        else
-        {
-            if (itr->second.SellPrice == 0)
-            {
-                continue;
-            }
-        }
+    query += " FROM mod_auctionhousebot";
 
-        //
-        // Exclude items with no costs associated, in any case
-        //
+    QueryResult result = WorldDatabase.Query(query);
 
-        if ((itr->second.BuyPrice == 0) && (itr->second.SellPrice == 0))
-        {
-            continue;
-        }
+    if (!result)
+    {
+        LOG_ERROR("module", "AHBot: could not read the settings of the auction houses from mod_auctionhousebot");
+        return;
+    }
 
-        //
-        // Exlude items superior to the limit quality
-        //
+    //
+    // The fields come in the order of the columns of the query
+    //
+
+    do
+    {
+        Field*            fields   = result->Fetch();
+        AHBHouseSettings& settings = houses[fields[0].Get<uint32>()];
 
-        if (itr->second.Quality > 6)
+        for (uint32 column = 0; column < columns; ++column)
         {
-            continue;
+            settings[AHBHouseColumns[column]] = fields[column + 1].Get<uint32>();
         }
+    } while (result->NextRow());
+}
 
-        //
-        // Exclude trade goods items
-        //
-
-        if (itr->second.Class == ITEM_CLASS_TRADE_GOODS)
-        {
-            bool isNpc   = false;
-            bool isLoot  = false;
-            bool exclude = false;
+uint32 AHBConfig::getHouseSetting(AHBHouseSettings const& settings, std::string const& column)
+{
+    AHBHouseSettings::const_iterator itr = settings.find(column);
 
-            if (NpcItems.find(itr->second.ItemId) != NpcItems.end())
-            {
-                isNpc = true;
+    if (itr == settings.end())
+    {
+        return 0;
+    }
 
-                if (!Vendor_TGs)
-                {
-                    exclude = true;
-                }
-            }
+    return itr->second;
+}
 
-            if (!exclude)
-            {
-                if (LootItems.find(itr->second.ItemId) != LootItems.end())
-                {
-                    isLoot = true;
+void AHBConfig::InitializeFromFile()
+{
+    //
+    // Load from, the configuration file
+    //
 
-                    if (!Loot_TGs)
-                    {
-                        exclude = true;
-                    }
-                }
-            }
+    DebugOut                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG"        , false);
+    DebugOutConfig                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_CONFIG" , false);
+    DebugOutFilters                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_FILTERS", false);
+    DebugOutBuyer                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_BUYER"  , false);
+    DebugOutSeller                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG_SELLER" , false);
 
-            if (exclude)
-            {
-                continue;
-            }
+    TraceSeller                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_SELLER" , false);
+    TraceBuyer                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.TRACE_BUYER"  , false);
 
-            if (!Other_TGs)
-            {
-                if (!isNpc && !isLoot)
-                {
-                    continue;
-                }
-            }
-        }
+    AHBSeller                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableSeller"           , false);
+    AHBBuyer                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.EnableBuyer"            , false);
+    SellMethod                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForSeller"   , false);
+    BuyMethod                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForBuyer"    , false);
+    SellAtMarketPrice              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseMarketPriceForSeller", false);
+    MarketResetThreshold           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketResetThreshold"   , 25);
+    DuplicatesCount                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 0);
+    DivisibleStacks                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DivisibleStacks"        , false);
+    ElapsingTimeClass              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 1);
+    ConsiderOnlyBotAuctions        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.ConsiderOnlyBotAuctions", false);
+    ItemsPerCycle                  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle"          , 200);
+    ListingsPerTransaction         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ListingsPerTransaction" , 0);
+    SellerTimeBudget               = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerTimeBudget"       , 0);
+    BuyerBestDeals                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.BuyerBestDeals"         , false);
+    BuyerExpiryWindow              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.BuyerExpiryWindow"      , 0);
+    SellerSleepTime                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerSleepTime"        , 0);
 
-        //
-        // Exclude loot items
-        //
+    //
+    // Flags: item types
+    //
 
-        if (itr->second.Class != ITEM_CLASS_TRADE_GOODS)
-        {
-            bool isNpc   = false;
-            bool isLoot  = false;
-            bool exclude = false;
+    Vendor_Items                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorItems"      , false);
+    Loot_Items                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootItems"        , true);
+    Other_Items                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherItems"       , false);
+    Vendor_TGs                     = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.VendorTradeGoods" , false);
+    Loot_TGs                       = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.LootTradeGoods"   , true);
+    Other_TGs                      = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.OtherTradeGoods"  , false);
 
-            if (NpcItems.find(itr->second.ItemId) != NpcItems.end())
-            {
-                isNpc = true;
+    //
+    // Flags: items binding
+    //
 
-                if (!Vendor_Items)
-                {
-                    exclude = true;
-                }
-            }
+    No_Bind                        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.No_Bind"             , true);
+    Bind_When_Picked_Up            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Picked_Up" , false);
+    Bind_When_Equipped             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Equipped"  , true);
+    Bind_When_Use                  = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_When_Use"       , true);
+    Bind_Quest_Item                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.Bind_Quest_Item"     , false);
 
-            if (!exclude)
-            {
-                if (LootItems.find(itr->second.ItemId) != LootItems.end())
-                {
-                    isLoot = true;
+    //
+    // Flags: misc
+    //
 
-                    if (!Loot_Items)
-                    {
-                        exclude = true;
-                    }
-                }
-            }
+    DisableConjured                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableConjured"               , false);
+    DisableGems                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableGems"                   , false);
+    DisableMoney                   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoney"                  , false);
+    DisableMoneyLoot               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMoneyLoot"              , false);
+    DisableLootable                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableLootable"               , false);
+    DisableKeys                    = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableKeys"                   , false);
+    DisableDuration                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDuration"               , false);
+    DisableBOP_Or_Quest_NoReqLevel = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableBOP_Or_Quest_NoReqLevel", false);
 
-            if (exclude)
-            {
-                continue;
-            }
+    //
+    // Flags: items per class
+    //
 
-            if (!Other_Items)
-            {
-                if (!isNpc && !isLoot)
-                {
-                    continue;
-                }
-            }
-        }
+    DisableWarriorItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarriorItems"    , false);
+    DisablePaladinItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePaladinItems"    , false);
+    DisableHunterItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableHunterItems"     , false);
+    DisableRogueItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableRogueItems"      , false);
+    DisablePriestItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisablePriestItems"     , false);
+    DisableDKItems                 = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDKItems"         , false);
+    DisableShamanItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableShamanItems"     , false);
+    DisableMageItems               = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableMageItems"       , false);
+    DisableWarlockItems            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableWarlockItems"    , false);
+    DisableUnusedClassItems        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableUnusedClassItems", false);
+    DisableDruidItems              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DisableDruidItems"      , false);
 
-        //
-        // Verify if the item is disabled or not in the whitelist
-        //
+    //
+    // Items level and skills
+    //
 
-        if (SellerWhiteList.size() == 0)
-        {
-            if (DisableItemStore.find(itr->second.ItemId) != DisableItemStore.end())
-            {
-                if (DebugOutFilters)
-                {
-                    LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (PTR/Beta/Unused Item)", itr->second.ItemId);
-                }
+    DisableItemsBelowLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowLevel"       , 0);
+    DisableItemsAboveLevel         = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveLevel"       , 0);
+    DisableItemsBelowGUID          = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowGUID"        , 0);
+    DisableItemsAboveGUID          = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveGUID"        , 0);
+    DisableItemsBelowReqLevel      = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowReqLevel"    , 0);
+    DisableItemsAboveReqLevel      = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveReqLevel"    , 0);
+    DisableItemsBelowReqSkillRank  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsBelowReqSkillRank", 0);
+    DisableItemsAboveReqSkillRank  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableItemsAboveReqSkillRank", 0);
 
-                continue;
-            }
-        }
-        else
-        {
-            if (SellerWhiteList.find(itr->second.ItemId) == SellerWhiteList.end())
-            {
-                if (DebugOutFilters)
-                {
-                    LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (not in the whitelist)", itr->second.ItemId);
-                }
+    //
+    // Trade goods level and skills
+    //
 
-                continue;
-            }
-        }
+    DisableTGsBelowLevel           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowLevel"       , 0);
+    DisableTGsAboveLevel           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveLevel"       , 0);
+    DisableTGsBelowGUID            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowGUID"        , 0);
+    DisableTGsAboveGUID            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveGUID"        , 0);
+    DisableTGsBelowReqLevel        = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowReqLevel"    , 0);
+    DisableTGsAboveReqLevel        = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveReqLevel"    , 0);
+    DisableTGsBelowReqSkillRank    = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsBelowReqSkillRank", 0);
+    DisableTGsAboveReqSkillRank    = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DisableTGsAboveReqSkillRank", 0);
 
-        //
-        // Disable permanent enchants items
-        //
+    //
+    // Whitelists
+    //
 
-        if ((DisablePermEnchant) && (itr->second.Class == ITEM_CLASS_PERMANENT))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Permanent Enchant Item)", itr->second.ItemId);
-            }
+    SellerWhiteList                = getCommaSeparatedIntegers(sConfigMgr->GetOption<std::string>("AuctionHouseBot.SellerWhiteList", ""));
+}
 
-            continue;
-        }
+void AHBConfig::InitializeFromSql(std::set<uint32> botsIds, AHBHousesSettings const& houses, std::shared_ptr<AHBItemSources const> sources)
+{
+    //
+    // Settings of this auction house, read at once with the ones of the other houses
+    //
 
-        //
-        // Disable conjured items
-        //
+    AHBHouseSettings                  settings;
+    AHBHousesSettings::const_iterator house = houses.find(GetAHID());
 
-        if ((DisableConjured) && (itr->second.IsConjuredConsumable()))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Conjured Consumable)", itr->second.ItemId);
-            }
+    if (house != houses.end())
+    {
+        settings = house->second;
+    }
+    else
+    {
+        LOG_ERROR("module", "AHBot: no settings for the auction house {} in mod_auctionhousebot", GetAHID());
+    }
 
-            continue;
-        }
+    //
+    // Load min and max items
+    //
 
-        //
-        // Disable gems
-        //
+    SetMinItems(getHouseSetting(settings, "minitems"));
+    SetMaxItems(getHouseSetting(settings, "maxitems"));
 
-        if ((DisableGems) && (itr->second.Class == ITEM_CLASS_GEM))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Gem)", itr->second.ItemId);
-            }
+    //
+    // Load percentages
+    //
 
-            continue;
-        }
+    uint32 greytg   = getHouseSetting(settings, "percentgreytradegoods");
+    uint32 whitetg  = getHouseSetting(settings, "percentwhitetradegoods");
+    uint32 greentg  = getHouseSetting(settings, "percentgreentradegoods");
+    uint32 bluetg   = getHouseSetting(settings, "percentbluetradegoods");
+    uint32 purpletg = getHouseSetting(settings, "percentpurpletradegoods");
+    uint32 orangetg = getHouseSetting(settings, "percentorangetradegoods");
+    uint32 yellowtg = getHouseSetting(settings, "percentyellowtradegoods");
+
+    uint32 greyi    = getHouseSetting(settings, "percentgreyitems");
+    uint32 whitei   = getHouseSetting(settings, "percentwhiteitems");
+    uint32 greeni   = getHouseSetting(settings, "percentgreenitems");
+    uint32 bluei    = getHouseSetting(settings, "percentblueitems");
+    uint32 purplei  = getHouseSetting(settings, "percentpurpleitems");
+    uint32 orangei  = getHouseSetting(settings, "percentorangeitems");
+    uint32 yellowi  = getHouseSetting(settings, "percentyellowitems");
 
-        //
-        // Disable money
-        //
+    SetPercentages(greytg, whitetg, greentg, bluetg, purpletg, orangetg, yellowtg, greyi, whitei, greeni, bluei, purplei, orangei, yellowi);
 
-        if ((DisableMoney) && (itr->second.Class == ITEM_CLASS_MONEY))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Money)", itr->second.ItemId);
-            }
+    // 
+    // Load min and max prices
+    // 
 
-            continue;
-        }
+    SetMinPrice(AHB_GREY  , getHouseSetting(settings, "minpricegrey"));
+    SetMaxPrice(AHB_GREY  , getHouseSetting(settings, "maxpricegrey"));
+    SetMinPrice(AHB_WHITE , getHouseSetting(settings, "minpricewhite"));
+    SetMaxPrice(AHB_WHITE , getHouseSetting(settings, "maxpricewhite"));
+    SetMinPrice(AHB_GREEN , getHouseSetting(settings, "minpricegreen"));
+    SetMaxPrice(AHB_GREEN , getHouseSetting(settings, "maxpricegreen"));
+    SetMinPrice(AHB_BLUE  , getHouseSetting(settings, "minpriceblue"));
+    SetMaxPrice(AHB_BLUE  , getHouseSetting(settings, "maxpriceblue"));
+    SetMinPrice(AHB_PURPLE, getHouseSetting(settings, "minpricepurple"));
+    SetMaxPrice(AHB_PURPLE, getHouseSetting(settings, "maxpricepurple"));
+    SetMinPrice(AHB_ORANGE, getHouseSetting(settings, "minpriceorange"));
+    SetMaxPrice(AHB_ORANGE, getHouseSetting(settings, "maxpriceorange"));
+    SetMinPrice(AHB_YELLOW, getHouseSetting(settings, "minpriceyellow"));
+    SetMaxPrice(AHB_YELLOW, getHouseSetting(settings, "maxpriceyellow"));
 
-        //
-        // Disable moneyloot
-        //
+    // 
+    // Load min and max bid prices
+    // 
 
-        if ((DisableMoneyLoot) && (itr->second.MinMoneyLoot > 0))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (MoneyLoot)", itr->second.ItemId);
-            }
+    SetMinBidPrice(AHB_GREY  , getHouseSetting(settings, "minbidpricegrey"));
+    SetMaxBidPrice(AHB_GREY  , getHouseSetting(settings, "maxbidpricegrey"));
+    SetMinBidPrice(AHB_WHITE , getHouseSetting(settings, "minbidpricewhite"));
+    SetMaxBidPrice(AHB_WHITE , getHouseSetting(settings, "maxbidpricewhite"));
+    SetMinBidPrice(AHB_GREEN , getHouseSetting(settings, "minbidpricegreen"));
+    SetMaxBidPrice(AHB_GREEN , getHouseSetting(settings, "maxbidpricegreen"));
+    SetMinBidPrice(AHB_BLUE  , getHouseSetting(settings, "minbidpriceblue"));
+    SetMaxBidPrice(AHB_BLUE  , getHouseSetting(settings, "maxbidpriceblue"));
+    SetMinBidPrice(AHB_PURPLE, getHouseSetting(settings, "minbidpricepurple"));
+    SetMaxBidPrice(AHB_PURPLE, getHouseSetting(settings, "maxbidpricepurple"));
+    SetMinBidPrice(AHB_ORANGE, getHouseSetting(settings, "minbidpriceorange"));
+    SetMaxBidPrice(AHB_ORANGE, getHouseSetting(settings, "maxbidpriceorange"));
+    SetMinBidPrice(AHB_YELLOW, getHouseSetting(settings, "minbidpriceyellow"));
+    SetMaxBidPrice(AHB_YELLOW, getHouseSetting(settings, "maxbidpriceyellow"));
 
-            continue;
-        }
+    // 
+    // Load max stacks
+    // 
 
-        //
-        // Disable lootable items
-        //
+    SetMaxStack(AHB_GREY  , getHouseSetting(settings, "maxstackgrey"));
+    SetMaxStack(AHB_WHITE , getHouseSetting(settings, "maxstackwhite"));
+    SetMaxStack(AHB_GREEN , getHouseSetting(settings, "maxstackgreen"));
+    SetMaxStack(AHB_BLUE  , getHouseSetting(settings, "maxstackblue"));
+    SetMaxStack(AHB_PURPLE, getHouseSetting(settings, "maxstackpurple"));
+    SetMaxStack(AHB_ORANGE, getHouseSetting(settings, "maxstackorange"));
+    SetMaxStack(AHB_YELLOW, getHouseSetting(settings, "maxstackyellow"));
 
-        if ((DisableLootable) && (itr->second.Flags & 4))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Lootable Item)", itr->second.ItemId);
-            }
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Settings for Auctionhouse {}", GetAHID());
 
-            continue;
-        }
+        LOG_INFO("module", "minItems                = {}", GetMinItems());
+        LOG_INFO("module", "maxItems                = {}", GetMaxItems());
 
-        //
-        // Disable Keys
-        //
+        LOG_INFO("module", "percentGreyTradeGoods   = {}", GetPercentages(AHB_GREY_TG));
+        LOG_INFO("module", "percentWhiteTradeGoods  = {}", GetPercentages(AHB_WHITE_TG));
+        LOG_INFO("module", "percentGreenTradeGoods  = {}", GetPercentages(AHB_GREEN_TG));
+        LOG_INFO("module", "percentBlueTradeGoods   = {}", GetPercentages(AHB_BLUE_TG));
+        LOG_INFO("module", "percentPurpleTradeGoods = {}", GetPercentages(AHB_PURPLE_TG));
+        LOG_INFO("module", "percentOrangeTradeGoods = {}", GetPercentages(AHB_ORANGE_TG));
+        LOG_INFO("module", "percentYellowTradeGoods = {}", GetPercentages(AHB_YELLOW_TG));
+        LOG_INFO("module", "percentGreyItems        = {}", GetPercentages(AHB_GREY_I));
+        LOG_INFO("module", "percentWhiteItems       = {}", GetPercentages(AHB_WHITE_I));
+        LOG_INFO("module", "percentGreenItems       = {}", GetPercentages(AHB_GREEN_I));
+        LOG_INFO("module", "percentBlueItems        = {}", GetPercentages(AHB_BLUE_I));
+        LOG_INFO("module", "percentPurpleItems      = {}", GetPercentages(AHB_PURPLE_I));
+        LOG_INFO("module", "percentOrangeItems      = {}", GetPercentages(AHB_ORANGE_I));
+        LOG_INFO("module", "percentYellowItems      = {}", GetPercentages(AHB_YELLOW_I));
 
-        if ((DisableKeys) && (itr->second.Class == ITEM_CLASS_KEY))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Quest Item)", itr->second.ItemId);
-            }
+        LOG_INFO("module", "minPriceGrey            = {}", GetMinPrice(AHB_GREY));
+        LOG_INFO("module", "maxPriceGrey            = {}", GetMaxPrice(AHB_GREY));
+        LOG_INFO("module", "minPriceWhite           = {}", GetMinPrice(AHB_WHITE));
+        LOG_INFO("module", "maxPriceWhite           = {}", GetMaxPrice(AHB_WHITE));
+        LOG_INFO("module", "minPriceGreen           = {}", GetMinPrice(AHB_GREEN));
+        LOG_INFO("module", "maxPriceGreen           = {}", GetMaxPrice(AHB_GREEN));
+        LOG_INFO("module", "minPriceBlue            = {}", GetMinPrice(AHB_BLUE));
+        LOG_INFO("module", "maxPriceBlue            = {}", GetMaxPrice(AHB_BLUE));
+        LOG_INFO("module", "minPricePurple          = {}", GetMinPrice(AHB_PURPLE));
+        LOG_INFO("module", "maxPricePurple          = {}", GetMaxPrice(AHB_PURPLE));
+        LOG_INFO("module", "minPriceOrange          = {}", GetMinPrice(AHB_ORANGE));
+        LOG_INFO("module", "maxPriceOrange          = {}", GetMaxPrice(AHB_ORANGE));
+        LOG_INFO("module", "minPriceYellow          = {}", GetMinPrice(AHB_YELLOW));
+        LOG_INFO("module", "maxPriceYellow          = {}", GetMaxPrice(AHB_YELLOW));
 
-            continue;
-        }
+        LOG_INFO("module", "minBidPriceGrey         = {}", GetMinBidPrice(AHB_GREY));
+        LOG_INFO("module", "maxBidPriceGrey         = {}", GetMaxBidPrice(AHB_GREY));
+        LOG_INFO("module", "minBidPriceWhite        = {}", GetMinBidPrice(AHB_WHITE));
+        LOG_INFO("module", "maxBidPriceWhite        = {}", GetMaxBidPrice(AHB_WHITE));
+        LOG_INFO("module", "minBidPriceGreen        = {}", GetMinBidPrice(AHB_GREEN));
+        LOG_INFO("module", "maxBidPriceGreen        = {}", GetMaxBidPrice(AHB_GREEN));
+        LOG_INFO("module", "minBidPriceBlue         = {}", GetMinBidPrice(AHB_BLUE));
+        LOG_INFO("module", "maxBidPriceBlue         = {}", GetMinBidPrice(AHB_BLUE));
+        LOG_INFO("module", "minBidPricePurple       = {}", GetMinBidPrice(AHB_PURPLE));
+        LOG_INFO("module", "maxBidPricePurple       = {}", GetMaxBidPrice(AHB_PURPLE));
+        LOG_INFO("module", "minBidPriceOrange       = {}", GetMinBidPrice(AHB_ORANGE));
+        LOG_INFO("module", "maxBidPriceOrange       = {}", GetMaxBidPrice(AHB_ORANGE));
+        LOG_INFO("module", "minBidPriceYellow       = {}", GetMinBidPrice(AHB_YELLOW));
+        LOG_INFO("module", "maxBidPriceYellow       = {}", GetMaxBidPrice(AHB_YELLOW));
 
-        //
-        // Disable items with duration
-        //
+        LOG_INFO("module", "maxStackGrey            = {}", GetMaxStack(AHB_GREY));
+        LOG_INFO("module", "maxStackWhite           = {}", GetMaxStack(AHB_WHITE));
+        LOG_INFO("module", "maxStackGreen           = {}", GetMaxStack(AHB_GREEN));
+        LOG_INFO("module", "maxStackBlue            = {}", GetMaxStack(AHB_BLUE));
+        LOG_INFO("module", "maxStackPurple          = {}", GetMaxStack(AHB_PURPLE));
+        LOG_INFO("module", "maxStackOrange          = {}", GetMaxStack(AHB_ORANGE));
+        LOG_INFO("module", "maxStackYellow          = {}", GetMaxStack(AHB_YELLOW));
+    }
 
-        if ((DisableDuration) && (itr->second.Duration > 0))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Has a Duration)", itr->second.ItemId);
-            }
+    //
+    // Reset the situation of the auction house
+    //
 
-            continue;
-        }
+    ResetItemCounts();
 
-        //
-        // Disable items which are BOP or Quest Items and have a required level lower than the item level
-        //
+    //
+    // Update the situation of the auction house
+    //
 
-        if ((DisableBOP_Or_Quest_NoReqLevel) && ((itr->second.Bonding == BIND_WHEN_PICKED_UP || itr->second.Bonding == BIND_QUEST_ITEM) && (itr->second.RequiredLevel < itr->second.ItemLevel)))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (BOP or BQI and Required Level is less than Item Level)", itr->second.ItemId);
-            }
+    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(GetAHFID());
+    uint32              auctions     = auctionHouse->Getcount();
 
-            continue;
-        }
+    if (auctions)
+    {
+        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+        {
+            AuctionEntry* Aentry = itr->second;
+            Item*         item   = sAuctionMgr->GetAItem(Aentry->item_guid);
 
-        //
-        // Disable items specifically for Warrior
-        //
+            //
+            // Keep track of what the bots are already selling, used to limit the duplicates and the refills,
+            // and of what the players are selling, which the buyer can bid on
+            //
 
-        if ((DisableWarriorItems) && (itr->second.AllowableClass == AHB_CLASS_WARRIOR))
-        {
-            if (DebugOutFilters)
+            if (botsIds.find(Aentry->owner.GetCounter()) != botsIds.end())
             {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Warrior Item)", itr->second.ItemId);
+                IncBotItemCounts   (Aentry->owner.GetCounter(), Aentry->item_template);
+                IncBotAuctionCounts(Aentry->owner.GetCounter());
+                AddSellerExpiry    (Aentry);
             }
-
-            continue;
-        }
-
-        //
-        // Disable items specifically for Paladin
-        //
-
-        if ((DisablePaladinItems) && (itr->second.AllowableClass == AHB_CLASS_PALADIN))
-        {
-            if (DebugOutFilters)
+            else
             {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Paladin Item)", itr->second.ItemId);
+                AddBuyerCandidate(Aentry);
             }
 
-            continue;
-        }
-
-        //
-        // Disable items specifically for Hunter
-        //
+            //
+            // If it has to only consider the bots auctions, skip the ones belonging to the players
+            //
 
-        if ((DisableHunterItems) && (itr->second.AllowableClass == AHB_CLASS_HUNTER))
-        {
-            if (DebugOutFilters)
+            if (ConsiderOnlyBotAuctions)
             {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Hunter Item)", itr->second.ItemId);
+                if (botsIds.find(Aentry->owner.GetCounter()) == botsIds.end())
+                {
+                    continue;
+                }
             }
 
-            continue;
-        }
-
-        //
-        // Disable items specifically for Rogue
-        //
-
-        if ((DisableRogueItems) && (itr->second.AllowableClass == AHB_CLASS_ROGUE))
-        {
-            if (DebugOutFilters)
+            if (item)
             {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Rogue Item)", itr->second.ItemId);
-            }
+                ItemTemplate const* prototype = item->GetTemplate();
 
-            continue;
-        }
+                if (prototype)
+                {
+                    switch (prototype->Quality)
+                    {
+                    case AHB_GREY:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_GREY_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_GREY_I);
+                        }
+                        break;
 
-        //
-        // Disable items specifically for Priest
-        //
+                    case AHB_WHITE:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_WHITE_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_WHITE_I);
+                        }
 
-        if ((DisablePriestItems) && (itr->second.AllowableClass == AHB_CLASS_PRIEST))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Priest Item)", itr->second.ItemId);
-            }
+                        break;
 
-            continue;
-        }
+                    case AHB_GREEN:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_GREEN_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_GREEN_I);
+                        }
 
-        //
-        // Disable items specifically for DK
-        //
+                        break;
 
-        if ((DisableDKItems) && (itr->second.AllowableClass == AHB_CLASS_DK))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (DK Item)", itr->second.ItemId);
-            }
+                    case AHB_BLUE:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_BLUE_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_BLUE_I);
+                        }
 
-            continue;
-        }
+                        break;
 
-        //
-        // Disable items specifically for Shaman
-        //
+                    case AHB_PURPLE:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_PURPLE_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_PURPLE_I);
+                        }
 
-        if ((DisableShamanItems) && (itr->second.AllowableClass == AHB_CLASS_SHAMAN))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Shaman Item)", itr->second.ItemId);
-            }
+                        break;
 
-            continue;
-        }
+                    case AHB_ORANGE:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_ORANGE_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_ORANGE_I);
+                        }
 
-        //
-        // Disable items specifically for Mage
-        //
+                        break;
 
-        if ((DisableMageItems) && (itr->second.AllowableClass == AHB_CLASS_MAGE))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Mage Item)", itr->second.ItemId);
-            }
+                    case AHB_YELLOW:
+                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
+                        {
+                            IncItemCounts(AHB_YELLOW_TG);
+                        }
+                        else
+                        {
+                            IncItemCounts(AHB_YELLOW_I);
+                        }
 
-            continue;
+                        break;
+                    }
+                }
+            }
         }
+    }
 
-        //
-        // Disable items specifically for Warlock
-        //
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Current situation for the auctionhouse {}", GetAHID());
+        LOG_INFO("module", "    Grey   Trade Goods {}", GetItemCounts(AHB_GREY_TG));
+        LOG_INFO("module", "    White  Trade Goods {}", GetItemCounts(AHB_WHITE_TG));
+        LOG_INFO("module", "    Green  Trade Goods {}", GetItemCounts(AHB_GREEN_TG));
+        LOG_INFO("module", "    Blue   Trade Goods {}", GetItemCounts(AHB_BLUE_TG));
+        LOG_INFO("module", "    Purple Trade Goods {}", GetItemCounts(AHB_PURPLE_TG));
+        LOG_INFO("module", "    Orange Trade Goods {}", GetItemCounts(AHB_ORANGE_TG));
+        LOG_INFO("module", "    Yellow Trade Goods {}", GetItemCounts(AHB_YELLOW_TG));
+        LOG_INFO("module", "    Grey   Items       {}", GetItemCounts(AHB_GREY_I));
+        LOG_INFO("module", "    White  Items       {}", GetItemCounts(AHB_WHITE_I));
+        LOG_INFO("module", "    Green  Items       {}", GetItemCounts(AHB_GREEN_I));
+        LOG_INFO("module", "    Blue   Items       {}", GetItemCounts(AHB_BLUE_I));
+        LOG_INFO("module", "    Purple Items       {}", GetItemCounts(AHB_PURPLE_I));
+        LOG_INFO("module", "    Orange Items       {}", GetItemCounts(AHB_ORANGE_I));
+        LOG_INFO("module", "    Yellow Items       {}", GetItemCounts(AHB_YELLOW_I));
+    }
 
-        if ((DisableWarlockItems) && (itr->second.AllowableClass == AHB_CLASS_WARLOCK))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Warlock Item)", itr->second.ItemId);
-            }
+    //
+    // Auctions buyer
+    //
 
-            continue;
-        }
+    SetBuyerPrice(AHB_GREY  , getHouseSetting(settings, "buyerpricegrey"));
+    SetBuyerPrice(AHB_WHITE , getHouseSetting(settings, "buyerpricewhite"));
+    SetBuyerPrice(AHB_GREEN , getHouseSetting(settings, "buyerpricegreen"));
+    SetBuyerPrice(AHB_BLUE  , getHouseSetting(settings, "buyerpriceblue"));
+    SetBuyerPrice(AHB_PURPLE, getHouseSetting(settings, "buyerpricepurple"));
+    SetBuyerPrice(AHB_ORANGE, getHouseSetting(settings, "buyerpriceorange"));
+    SetBuyerPrice(AHB_YELLOW, getHouseSetting(settings, "buyerpriceyellow"));
 
-        //
-        // Disable items specifically for Unused Class
-        //
+    //
+    // Load bidding interval
+    //
 
-        if ((DisableUnusedClassItems) && (itr->second.AllowableClass == AHB_CLASS_UNUSED))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Unused Item)", itr->second.ItemId);
-            }
+    SetBiddingInterval(getHouseSetting(settings, "buyerbiddinginterval"));
 
-            continue;
-        }
+    //
+    // Load bids per interval
+    //
 
-        //
-        // Disable items specifically for Druid
-        //
+    SetBidsPerInterval(getHouseSetting(settings, "buyerbidsperinterval"));
 
-        if ((DisableDruidItems) && (itr->second.AllowableClass == AHB_CLASS_DRUID))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Druid Item)", itr->second.ItemId);
-            }
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Current Settings for Auctionhouse {} buyer", GetAHID());
+        LOG_INFO("module", "buyerPriceGrey          = {}", GetBuyerPrice(AHB_GREY));
+        LOG_INFO("module", "buyerPriceWhite         = {}", GetBuyerPrice(AHB_WHITE));
+        LOG_INFO("module", "buyerPriceGreen         = {}", GetBuyerPrice(AHB_GREEN));
+        LOG_INFO("module", "buyerPriceBlue          = {}", GetBuyerPrice(AHB_BLUE));
+        LOG_INFO("module", "buyerPricePurple        = {}", GetBuyerPrice(AHB_PURPLE));
+        LOG_INFO("module", "buyerPriceOrange        = {}", GetBuyerPrice(AHB_ORANGE));
+        LOG_INFO("module", "buyerPriceYellow        = {}", GetBuyerPrice(AHB_YELLOW));
+        LOG_INFO("module", "buyerBiddingInterval    = {}", GetBiddingInterval());
+        LOG_INFO("module", "buyerBidsPerInterval    = {}", GetBidsPerInterval());
+    }
 
-            continue;
-        }
+    //
+    // The disabled, vendor and lootable items are read once for all the auction houses
+    //
 
-        //
-        // Disable Items below level X
-        //
+    ItemSources = sources;
+}
 
-        if ((DisableItemsBelowLevel) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemLevel < DisableItemsBelowLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Item Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+void AHBConfig::PrepareBins(uint32 slices, std::vector<std::function<void()>>& tasks, AHBBinCache const* cache)
+{
+    //
+    // Exclude items depending on the configuration; whatever passes all the tests is put in the lists.
+    // The tests shared by all the items are masks of features, the others depend on the kind of the item.
+    //
 
-            continue;
-        }
+    AHBItemFilter filter;
+
+    filter.Required  = SellMethod ? AHB_FEATURE_BUY_PRICE : AHB_FEATURE_SELL_PRICE;
+
+    filter.Excluded |= No_Bind             ? 0 : AHB_FEATURE_NO_BIND;
+    filter.Excluded |= Bind_When_Picked_Up ? 0 : AHB_FEATURE_BIND_PICKED_UP;
+    filter.Excluded |= Bind_When_Equipped  ? 0 : AHB_FEATURE_BIND_EQUIPPED;
+    filter.Excluded |= Bind_When_Use       ? 0 : AHB_FEATURE_BIND_USE;
+    filter.Excluded |= Bind_Quest_Item     ? 0 : AHB_FEATURE_BIND_QUEST;
+
+    filter.Excluded |= SellerWhiteList.empty() ? AHB_FEATURE_DISABLED : 0;
+
+    filter.Excluded |= DisablePermEnchant             ? AHB_FEATURE_PERM_ENCHANT : 0;
+    filter.Excluded |= DisableConjured                ? AHB_FEATURE_CONJURED : 0;
+    filter.Excluded |= DisableGems                    ? AHB_FEATURE_GEM : 0;
+    filter.Excluded |= DisableMoney                   ? AHB_FEATURE_MONEY : 0;
+    filter.Excluded |= DisableMoneyLoot               ? AHB_FEATURE_MONEY_LOOT : 0;
+    filter.Excluded |= DisableLootable                ? AHB_FEATURE_LOOTABLE : 0;
+    filter.Excluded |= DisableKeys                    ? AHB_FEATURE_KEY : 0;
+    filter.Excluded |= DisableDuration                ? AHB_FEATURE_DURATION : 0;
+    filter.Excluded |= DisableBOP_Or_Quest_NoReqLevel ? AHB_FEATURE_BOP_NO_REQ_LEVEL : 0;
+
+    filter.Excluded |= DisableWarriorItems     ? AHB_FEATURE_CLASS_WARRIOR : 0;
+    filter.Excluded |= DisablePaladinItems     ? AHB_FEATURE_CLASS_PALADIN : 0;
+    filter.Excluded |= DisableHunterItems      ? AHB_FEATURE_CLASS_HUNTER : 0;
+    filter.Excluded |= DisableRogueItems       ? AHB_FEATURE_CLASS_ROGUE : 0;
+    filter.Excluded |= DisablePriestItems      ? AHB_FEATURE_CLASS_PRIEST : 0;
+    filter.Excluded |= DisableDKItems          ? AHB_FEATURE_CLASS_DK : 0;
+    filter.Excluded |= DisableShamanItems      ? AHB_FEATURE_CLASS_SHAMAN : 0;
+    filter.Excluded |= DisableMageItems        ? AHB_FEATURE_CLASS_MAGE : 0;
+    filter.Excluded |= DisableWarlockItems     ? AHB_FEATURE_CLASS_WARLOCK : 0;
+    filter.Excluded |= DisableUnusedClassItems ? AHB_FEATURE_CLASS_UNUSED : 0;
+    filter.Excluded |= DisableDruidItems       ? AHB_FEATURE_CLASS_DRUID : 0;
 
-        //
-        // Disable Items above level X
-        //
+    //
+    // Trade goods
+    //
 
-        if ((DisableItemsAboveLevel) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemLevel > DisableItemsAboveLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Item Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+    binTradeGoodsFilter = filter;
 
-            continue;
-        }
+    binTradeGoodsFilter.Excluded |= Vendor_TGs ? 0 : AHB_FEATURE_VENDOR;
+    binTradeGoodsFilter.Excluded |= Loot_TGs   ? 0 : AHB_FEATURE_LOOT;
+    binTradeGoodsFilter.Excluded |= Other_TGs  ? 0 : AHB_FEATURE_OTHER;
 
-        //
-        // Disable Trade Goods below level X
-        //
+    binTradeGoodsFilter.MinItemLevel = DisableTGsBelowLevel;
+    binTradeGoodsFilter.MaxItemLevel = DisableTGsAboveLevel        ? DisableTGsAboveLevel : 0xFFFFFFFF;
+    binTradeGoodsFilter.MinItemId    = DisableTGsBelowGUID;
+    binTradeGoodsFilter.MaxItemId    = DisableTGsAboveGUID         ? DisableTGsAboveGUID : 0xFFFFFFFF;
+    binTradeGoodsFilter.MinReqLevel  = DisableTGsBelowReqLevel;
+    binTradeGoodsFilter.MaxReqLevel  = DisableTGsAboveReqLevel     ? DisableTGsAboveReqLevel : 0xFFFFFFFF;
+    binTradeGoodsFilter.MinSkillRank = DisableTGsBelowReqSkillRank;
+    binTradeGoodsFilter.MaxSkillRank = DisableTGsAboveReqSkillRank ? DisableTGsAboveReqSkillRank : 0xFFFFFFFF;
 
-        if ((DisableTGsBelowLevel) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemLevel < DisableTGsBelowLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Trade Good {} disabled (Trade Good Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+    //
+    // All the other items
+    //
 
-            continue;
-        }
+    binItemsFilter = filter;
 
-        //
-        // Disable Trade Goods above level X
-        //
+    binItemsFilter.Excluded |= Vendor_Items ? 0 : AHB_FEATURE_VENDOR;
+    binItemsFilter.Excluded |= Loot_Items   ? 0 : AHB_FEATURE_LOOT;
+    binItemsFilter.Excluded |= Other_Items  ? 0 : AHB_FEATURE_OTHER;
 
-        if ((DisableTGsAboveLevel) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemLevel > DisableTGsAboveLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Trade Good {} disabled (Trade Good Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+    binItemsFilter.MinItemLevel = DisableItemsBelowLevel;
+    binItemsFilter.MaxItemLevel = DisableItemsAboveLevel        ? DisableItemsAboveLevel : 0xFFFFFFFF;
+    binItemsFilter.MinItemId    = DisableItemsBelowGUID;
+    binItemsFilter.MaxItemId    = DisableItemsAboveGUID         ? DisableItemsAboveGUID : 0xFFFFFFFF;
+    binItemsFilter.MinReqLevel  = DisableItemsBelowReqLevel;
+    binItemsFilter.MaxReqLevel  = DisableItemsAboveReqLevel     ? DisableItemsAboveReqLevel : 0xFFFFFFFF;
+    binItemsFilter.MinSkillRank = DisableItemsBelowReqSkillRank;
+    binItemsFilter.MaxSkillRank = DisableItemsAboveReqSkillRank ? DisableItemsAboveReqSkillRank : 0xFFFFFFFF;
 
-            continue;
-        }
+    //
+    // The filters, the price and the whitelist identify the bins in the cache
+    //
 
-        //
-        // Disable Items below GUID X
-        //
+    binsHash = AHBBinCache::HashSeed;
 
-        if ((DisableItemsBelowGUID) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemId < DisableItemsBelowGUID))
+    for (AHBItemFilter const* filter: { &binItemsFilter, &binTradeGoodsFilter })
+    {
+        uint32 const fields[] =
         {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Item Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+            filter->Required    , filter->Excluded,
+            filter->MinItemLevel, filter->MaxItemLevel, filter->MinItemId  , filter->MaxItemId,
+            filter->MinReqLevel , filter->MaxReqLevel , filter->MinSkillRank, filter->MaxSkillRank
+        };
 
-            continue;
-        }
-
-        //
-        // Disable Items above GUID X
-        //
+        binsHash = AHBBinCache::Hash(binsHash, fields, sizeof(fields));
+    }
 
-        if ((DisableItemsAboveGUID) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemId > DisableItemsAboveGUID))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Item Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+    binsHash = AHBBinCache::Hash(binsHash, bool(SellMethod));
 
-            continue;
-        }
+    for (uint32 itemId: SellerWhiteList)
+    {
+        binsHash = AHBBinCache::Hash(binsHash, itemId);
+    }
 
-        //
-        // Disable Trade Goods below GUID X
-        //
+    binSlices.clear();
 
-        if ((DisableTGsBelowGUID) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemId < DisableTGsBelowGUID))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Trade Good Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
+    //
+    // Bins found in the cache make a single slice, already filled. The filtered items are only reported by an actual filtering.
+    //
 
-            continue;
-        }
+    if (cache && !DebugOutFilters)
+    {
+        AHBBinSlice cached;
 
-        //
-        // Disable Trade Goods above GUID X
-        //
+        cached.First = 0;
+        cached.Last  = 0;
 
-        if ((DisableTGsAboveGUID) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.ItemId > DisableTGsAboveGUID))
+        if (cache->GetBins(AHID, binsHash, cached.Bins))
         {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (Trade Good Level = {})", itr->second.ItemId, itr->second.ItemLevel);
-            }
-
-            continue;
+            binSlices.push_back(std::move(cached));
+            return;
         }
+    }
 
-        //
-        // Disable Items for level lower than X
-        //
-
-        if ((DisableItemsBelowReqLevel) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredLevel < DisableItemsBelowReqLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredLevel = {})", itr->second.ItemId, itr->second.RequiredLevel);
-            }
+    //
+    // The item templates are split in slices of about the same size, filtered by the tasks independently of each other
+    //
 
-            continue;
-        }
+    uint32 count = ItemSources->GetTemplateCount();
 
-        //
-        // Disable Items for level higher than X
-        //
+    if (slices == 0)
+    {
+        slices = 1;
+    }
 
-        if ((DisableItemsAboveReqLevel) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredLevel > DisableItemsAboveReqLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredLevel = {})", itr->second.ItemId, itr->second.RequiredLevel);
-            }
+    binSlices.resize(slices);
 
-            continue;
-        }
+    for (uint32 slice = 0; slice < slices; ++slice)
+    {
+        AHBBinSlice* part = &binSlices[slice];
 
-        //
-        // Disable Trade Goods for level lower than X
-        //
+        part->First = uint32(uint64(count) * slice / slices);
+        part->Last  = uint32(uint64(count) * (slice + 1) / slices);
 
-        if ((DisableTGsBelowReqLevel) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredLevel < DisableTGsBelowReqLevel))
+        tasks.push_back([this, part]()
         {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Trade Good {} disabled (RequiredLevel = {})", itr->second.ItemId, itr->second.RequiredLevel);
-            }
-
-            continue;
-        }
+            fillBinSlice(*part);
+        });
+    }
+}
 
-        //
-        // Disable Trade Goods for level higher than X
-        //
+void AHBConfig::fillBinSlice(AHBBinSlice& slice)
+{
+    std::vector<uint32> passed;
 
-        if ((DisableTGsAboveReqLevel) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredLevel > DisableTGsAboveReqLevel))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Trade Good {} disabled (RequiredLevel = {})", itr->second.ItemId, itr->second.RequiredLevel);
-            }
+    ItemSources->Filter(binItemsFilter, binTradeGoodsFilter, slice.First, slice.Last, passed, DebugOutFilters ? &slice.Rejected : NULL);
 
-            continue;
-        }
+    for (uint32 index: passed)
+    {
+        ItemTemplate const* proto = ItemSources->GetTemplate(index);
 
         //
-        // Disable Items that require skill lower than X
+        // Verify if the item is in the whitelist
         //
 
-        if ((DisableItemsBelowReqSkillRank) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredSkillRank < DisableItemsBelowReqSkillRank))
+        if (!SellerWhiteList.empty() && SellerWhiteList.find(proto->ItemId) == SellerWhiteList.end())
         {
             if (DebugOutFilters)
             {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredSkillRank = {})", itr->second.ItemId, itr->second.RequiredSkillRank);
+                slice.Rejected.push_back(index);
             }
 
             continue;
         }
 
         //
-        // Disable Items that require skill higher than X
+        // Now that the items passed all the tests, describe them for the seller and organize them by category
         //
 
-        if ((DisableItemsAboveReqSkillRank) && (itr->second.Class != ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredSkillRank > DisableItemsAboveReqSkillRank))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredSkillRank = {})", itr->second.ItemId, itr->second.RequiredSkillRank);
-            }
-
-            continue;
-        }
+        AHBListing listing;
 
-        //
-        // Disable Trade Goods that require skill lower than X
-        //
+        listing.ItemId         = proto->ItemId;
+        listing.BasePrice      = SellMethod ? uint32(proto->BuyPrice) : proto->SellPrice;
+        listing.MaxStack       = proto->GetMaxStackSize();
+        listing.Quality        = uint8(proto->Quality);
+        listing.Category       = uint8(proto->Quality + (proto->Class == ITEM_CLASS_TRADE_GOODS ? AHB_GREY_TG : AHB_GREY_I));
+        listing.RandomProperty = proto->RandomProperty != 0 || proto->RandomSuffix != 0;
 
-        if ((DisableTGsBelowReqSkillRank) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredSkillRank < DisableTGsBelowReqSkillRank))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredSkillRank = {})", itr->second.ItemId, itr->second.RequiredSkillRank);
-            }
+        slice.Bins[listing.Category].push_back(listing);
+    }
 
-            continue;
-        }
+    //
+    // The rejected items are reported in the order of the templates
+    //
 
-        //
-        // Disable Trade Goods that require skill higher than X
-        //
+    std::sort(slice.Rejected.begin(), slice.Rejected.end());
+}
 
-        if ((DisableTGsAboveReqSkillRank) && (itr->second.Class == ITEM_CLASS_TRADE_GOODS) && (itr->second.RequiredSkillRank > DisableTGsAboveReqSkillRank))
-        {
-            if (DebugOutFilters)
-            {
-                LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredSkillRank = {})", itr->second.ItemId, itr->second.RequiredSkillRank);
-            }
+void AHBConfig::InitializeBins()
+{
+    //
+    // Without a previous PrepareBins(), all the item templates are filtered here at once
+    //
 
-            continue;
-        }
+    if (binSlices.empty())
+    {
+        std::vector<std::function<void()>> tasks;
 
-        //
-        // Now that the items passed all the tests, organize it by quality
-        //
+        PrepareBins(1, tasks, NULL);
 
-        if (itr->second.Class == ITEM_CLASS_TRADE_GOODS)
+        for (std::function<void()> const& task: tasks)
         {
-            switch (itr->second.Quality)
-            {
-            case AHB_GREY:
-                GreyTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+            task();
+        }
+    }
 
-            case AHB_WHITE:
-                WhiteTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+    std::vector<AHBListing>* bins[AHB_CATEGORIES] =
+    {
+        &GreyTradeGoodsBin, &WhiteTradeGoodsBin, &GreenTradeGoodsBin, &BlueTradeGoodsBin, &PurpleTradeGoodsBin, &OrangeTradeGoodsBin, &YellowTradeGoodsBin,
+        &GreyItemsBin     , &WhiteItemsBin     , &GreenItemsBin     , &BlueItemsBin     , &PurpleItemsBin     , &OrangeItemsBin     , &YellowItemsBin
+    };
 
-            case AHB_GREEN:
-                GreenTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+    //
+    // The bins are plain arrays, so they must be emptied before being filled again on reload.
+    // The slices are merged in their order: the bins do not depend on how many slices were used.
+    //
 
-            case AHB_BLUE:
-                BlueTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        size_t size = 0;
 
-            case AHB_PURPLE:
-                PurpleTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+        for (AHBBinSlice const& slice: binSlices)
+        {
+            size += slice.Bins[category].size();
+        }
 
-            case AHB_ORANGE:
-                OrangeTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+        bins[category]->clear();
+        bins[category]->reserve(size);
 
-            case AHB_YELLOW:
-                YellowTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-            }
+        for (AHBBinSlice const& slice: binSlices)
+        {
+            bins[category]->insert(bins[category]->end(), slice.Bins[category].begin(), slice.Bins[category].end());
         }
-        else
+    }
+
+    if (DebugOutFilters)
+    {
+        for (AHBBinSlice const& slice: binSlices)
         {
-            switch (itr->second.Quality)
+            for (uint32 index: slice.Rejected)
             {
-            case AHB_GREY:
-                GreyItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_WHITE:
-                WhiteItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_GREEN:
-                GreenItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_BLUE:
-                BlueItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_PURPLE:
-                PurpleItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_ORANGE:
-                OrangeItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_YELLOW:
-                YellowItemsBin.insert(itr->second.ItemId);
-                break;
+                logFilteredItem(index);
             }
         }
     }
 
+    binSlices.clear();
+
     // 
     // Perform reporting and the last check: if no items are disabled or in the whitelist clear the bin making the selling useless
     // 
@@ -3333,7 +3280,7 @@ void AHBConfig::InitializeBins()
 
     if (SellerWhiteList.size() == 0)
     {
-        if (DisableItemStore.size() == 0)
+        if (ItemSources->GetDisabledCount() == 0)
         {
             LOG_ERROR("module", "AHBot: No items are disabled or in the whitelist! Selling will be disabled!");
 
@@ -3357,13 +3304,33 @@ void AHBConfig::InitializeBins()
             return;
         }
 
-        LOG_INFO("module", "AHBot: {} disabled items", uint32(DisableItemStore.size()));
+        LOG_INFO("module", "AHBot: {} disabled items", ItemSources->GetDisabledCount());
     }
     else
     {
         LOG_INFO("module", "AHBot: Using a whitelist of {} items", uint32(SellerWhiteList.size()));
     }
 
+    //
+    // The bins will not change until the next reload: release the memory reserved in excess
+    //
+
+    GreyTradeGoodsBin.shrink_to_fit();
+    WhiteTradeGoodsBin.shrink_to_fit();
+    GreenTradeGoodsBin.shrink_to_fit();
+    BlueTradeGoodsBin.shrink_to_fit();
+    PurpleTradeGoodsBin.shrink_to_fit();
+    OrangeTradeGoodsBin.shrink_to_fit();
+    YellowTradeGoodsBin.shrink_to_fit();
+
+    GreyItemsBin.shrink_to_fit();
+    WhiteItemsBin.shrink_to_fit();
+    GreenItemsBin.shrink_to_fit();
+    BlueItemsBin.shrink_to_fit();
+    PurpleItemsBin.shrink_to_fit();
+    OrangeItemsBin.shrink_to_fit();
+    YellowItemsBin.shrink_to_fit();
+
     LOG_INFO("module", "AHBot: loaded {} grey   trade goods", uint32(GreyTradeGoodsBin.size()));
     LOG_INFO("module", "AHBot: loaded {} white  trade goods", uint32(WhiteTradeGoodsBin.size()));
     LOG_INFO("module", "AHBot: loaded {} green  trade goods", uint32(GreenTradeGoodsBin.size()));
@@ -3380,6 +3347,86 @@ void AHBConfig::InitializeBins()
     LOG_INFO("module", "AHBot: loaded {} yellow items"      , uint32(YellowItemsBin.size()));
 }
 
+void AHBConfig::logFilteredItem(uint32 index)
+{
+    //
+    // Only the first reason is reported, in the order of the configuration file; binding, price and origin are not reported
+    //
+
+    static std::pair<uint32, char const*> const reasons[] =
+    {
+        { AHB_FEATURE_DISABLED        , "PTR/Beta/Unused Item"                                    },
+        { AHB_FEATURE_PERM_ENCHANT    , "Permanent Enchant Item"                                  },
+        { AHB_FEATURE_CONJURED        , "Conjured Consumable"                                     },
+        { AHB_FEATURE_GEM             , "Gem"                                                     },
+        { AHB_FEATURE_MONEY           , "Money"                                                   },
+        { AHB_FEATURE_MONEY_LOOT      , "MoneyLoot"                                               },
+        { AHB_FEATURE_LOOTABLE        , "Lootable Item"                                           },
+        { AHB_FEATURE_KEY             , "Quest Item"                                              },
+        { AHB_FEATURE_DURATION        , "Has a Duration"                                          },
+        { AHB_FEATURE_BOP_NO_REQ_LEVEL, "BOP or BQI and Required Level is less than Item Level" },
+        { AHB_FEATURE_CLASS_WARRIOR   , "Warrior Item"                                            },
+        { AHB_FEATURE_CLASS_PALADIN   , "Paladin Item"                                            },
+        { AHB_FEATURE_CLASS_HUNTER    , "Hunter Item"                                             },
+        { AHB_FEATURE_CLASS_ROGUE     , "Rogue Item"                                              },
+        { AHB_FEATURE_CLASS_PRIEST    , "Priest Item"                                             },
+        { AHB_FEATURE_CLASS_DK        , "DK Item"                                                 },
+        { AHB_FEATURE_CLASS_SHAMAN    , "Shaman Item"                                             },
+        { AHB_FEATURE_CLASS_MAGE      , "Mage Item"                                               },
+        { AHB_FEATURE_CLASS_WARLOCK   , "Warlock Item"                                            },
+        { AHB_FEATURE_CLASS_UNUSED    , "Unused Item"                                             },
+        { AHB_FEATURE_CLASS_DRUID     , "Druid Item"                                              }
+    };
+
+    ItemTemplate const*  proto     = ItemSources->GetTemplate(index);
+    uint32               features  = ItemSources->GetFeatures(index);
+    bool                 tradeGood = (features & AHB_FEATURE_TRADE_GOODS) != 0;
+    AHBItemFilter const& filter    = tradeGood ? binTradeGoodsFilter : binItemsFilter;
+    char const*          kind      = tradeGood ? "Trade Good" : "Item";
+
+    if (features & filter.Excluded & (AHB_FEATURE_NO_BIND | AHB_FEATURE_BIND_PICKED_UP | AHB_FEATURE_BIND_EQUIPPED | AHB_FEATURE_BIND_USE | AHB_FEATURE_BIND_QUEST | AHB_FEATURE_VENDOR | AHB_FEATURE_LOOT | AHB_FEATURE_OTHER))
+    {
+        return;
+    }
+
+    if ((features & filter.Required) != filter.Required)
+    {
+        return;
+    }
+
+    if (!SellerWhiteList.empty() && SellerWhiteList.find(proto->ItemId) == SellerWhiteList.end())
+    {
+        LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (not in the whitelist)", proto->ItemId);
+        return;
+    }
+
+    for (std::pair<uint32, char const*> const& reason: reasons)
+    {
+        if (features & filter.Excluded & reason.first)
+        {
+            LOG_ERROR("module", "AuctionHouseBot: Item {} disabled ({})", proto->ItemId, reason.second);
+            return;
+        }
+    }
+
+    if (proto->ItemLevel < filter.MinItemLevel || proto->ItemLevel > filter.MaxItemLevel)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: {} {} disabled ({} Level = {})", kind, proto->ItemId, kind, proto->ItemLevel);
+    }
+    else if (proto->ItemId < filter.MinItemId || proto->ItemId > filter.MaxItemId)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: Item {} disabled ({} Level = {})", proto->ItemId, kind, proto->ItemLevel);
+    }
+    else if (proto->RequiredLevel < filter.MinReqLevel || proto->RequiredLevel > filter.MaxReqLevel)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: {} {} disabled (RequiredLevel = {})", kind, proto->ItemId, proto->RequiredLevel);
+    }
+    else if (proto->RequiredSkillRank < filter.MinSkillRank || proto->RequiredSkillRank > filter.MaxSkillRank)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: Item {} disabled (RequiredSkillRank = {})", proto->ItemId, proto->RequiredSkillRank);
+    }
+}
+
 std::set<uint32> AHBConfig::getCommaSeparatedIntegers(std::string text)
 {
     std::string       value;
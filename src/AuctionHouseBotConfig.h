@@ -20,12 +20,56 @@
 #ifndef AUCTION_HOUSE_BOT_CONFIG_H
 #define AUCTION_HOUSE_BOT_CONFIG_H
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ObjectMgr.h"
 
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotItemSources.h"
+#include "AuctionHouseBotWheel.h"
+
+struct AuctionEntry;
+class  AHBBinCache;
+
+//
+// What the seller needs to know about an item, resolved once when the bins are filled
+//
+
+struct AHBListing
+{
+    uint32 ItemId;         // Item template
+    uint32 BasePrice;      // Buy or sell price of the template, depending on SellMethod
+    uint32 MaxStack;       // Largest stack allowed by the template
+    uint8  Quality;        // Quality of the item, never above AHB_MAX_QUALITY
+    uint8  Category;       // Bin holding the listing, from AHB_GREY_TG to AHB_YELLOW_I
+    bool   RandomProperty; // The item can roll a random property or suffix
+};
+
+//
+// Part of the bins built from a range of the item templates, possibly on another thread
+//
+
+struct AHBBinSlice
+{
+    uint32                  First;                 // Range of template indexes in the item sources
+    uint32                  Last;
+    std::vector<AHBListing> Bins[AHB_CATEGORIES];  // Listings by category
+    std::vector<uint32>     Rejected;              // Templates filtered out, only when they are reported
+};
+
+//
+// Settings of the auction houses stored in mod_auctionhousebot, by auction house id and column name
+//
+
+typedef std::map<std::string, uint32>      AHBHouseSettings;
+typedef std::map<uint32, AHBHouseSettings> AHBHousesSettings;
+
 class AHBConfig
 {
 private:
@@ -143,6 +187,51 @@ private:
     uint32 orangeItems;
     uint32 yellowItems;
 
+    //
+    // Amount of auctions listed by the bots, indexed by bot and item template
+    //
+
+    std::unordered_map<uint64, uint32> botItemsCount;
+
+    //
+    // Amount of auctions listed by each bot
+    //
+
+    std::unordered_map<uint32, uint32> botAuctionsCount;
+
+    //
+    // Auctions of the players the buyer can bid on, with the position of each one in the array.
+    // The auctions where a bot leads the bidding stay in the array: a player can outbid it without
+    // any hook being called, so they are skipped when drawn instead of being removed.
+    //
+
+    std::vector<uint32>                buyerCandidates;
+    std::unordered_map<uint32, uint32> buyerCandidatesPos;
+
+    //
+    // Candidates worth a bid, ordered by asked price over reference price, with the ratio each one is ranked by.
+    // The ranking is dirty when the buyer prices changed and has to be built again.
+    //
+
+    std::set<std::pair<double, uint32>> buyerDeals;
+    std::unordered_map<uint32, double>  buyerDealsRatio;
+    bool                                buyerDealsDirty;
+
+    //
+    // Auctions by expiration time: the ones of the bots, to know when they lapse, and the ones of the players
+    //
+
+    AHBExpiryWheel sellerExpiries;
+    AHBExpiryWheel buyerExpiries;
+
+    //
+    // Sellers with nothing to do, by bot: the wake-up counter and the time when each one went dormant.
+    // Every market event that can free room in the auction house increments the counter.
+    //
+
+    std::unordered_map<uint32, std::pair<uint32, time_t>> sellersDormant;
+    uint32                                                sellersWakeUps;
+
     // 
     // Per-item statistics
     //
@@ -152,10 +241,30 @@ private:
     std::map<uint32, uint64> itemsPrice;
 
     void   InitializeFromFile();
-    void   InitializeFromSql(std::set<uint32> botsIds);
+    void   InitializeFromSql(std::set<uint32> botsIds, AHBHousesSettings const& houses, std::shared_ptr<AHBItemSources const> sources);
+
+    uint32 getHouseSetting(AHBHouseSettings const& settings, std::string const& column);
+
+    //
+    // Building of the bins
+    //
+
+    AHBItemFilter            binItemsFilter;
+    AHBItemFilter            binTradeGoodsFilter;
+    std::vector<AHBBinSlice> binSlices;
+    uint64                   binsHash;  // Options the bins were filtered with
+
+    void   fillBinSlice   (AHBBinSlice& slice);
+    void   logFilteredItem(uint32 index);
 
     std::set<uint32> getCommaSeparatedIntegers(std::string text);
 
+    bool   getBuyerDealRatio(AuctionEntry* auction, double& ratio);
+    void   rankBuyerDeal    (AuctionEntry* auction);
+    void   unrankBuyerDeal  (uint32 auctionId);
+
+    void   swapBuyerCandidates(uint32 i, uint32 j);
+
 public:
     //
     // Debugging
@@ -186,6 +295,12 @@ public:
     uint32 MarketResetThreshold;
     bool   ConsiderOnlyBotAuctions;
     uint32 ItemsPerCycle;
+    uint32 ListingsPerTransaction;
+    uint32 SellerTimeBudget;
+
+    bool   BuyerBestDeals;
+    uint32 BuyerExpiryWindow;
+    uint32 SellerSleepTime;
 
     //
     // Filters
@@ -258,34 +373,32 @@ public:
     // Items validity for selling purposes
     //
 
-    std::set<uint32> NpcItems;
-    std::set<uint32> LootItems;
-    std::set<uint32> DisableItemStore;
-    std::set<uint32> SellerWhiteList;
+    std::shared_ptr<AHBItemSources const> ItemSources; // Shared by all the auction houses
+    std::set<uint32>                      SellerWhiteList;
 
     //
-    // Bins for trade goods.
+    // Bins for trade goods; filled by PrepareBins() and InitializeBins(), then read-only
     //
 
-    std::set<uint32> GreyTradeGoodsBin;
-    std::set<uint32> WhiteTradeGoodsBin;
-    std::set<uint32> GreenTradeGoodsBin;
-    std::set<uint32> BlueTradeGoodsBin;
-    std::set<uint32> PurpleTradeGoodsBin;
-    std::set<uint32> OrangeTradeGoodsBin;
-    std::set<uint32> YellowTradeGoodsBin;
+    std::vector<AHBListing> GreyTradeGoodsBin;
+    std::vector<AHBListing> WhiteTradeGoodsBin;
+    std::vector<AHBListing> GreenTradeGoodsBin;
+    std::vector<AHBListing> BlueTradeGoodsBin;
+    std::vector<AHBListing> PurpleTradeGoodsBin;
+    std::vector<AHBListing> OrangeTradeGoodsBin;
+    std::vector<AHBListing> YellowTradeGoodsBin;
 
     //
     // Bins for items
     //
 
-    std::set<uint32> GreyItemsBin;
-    std::set<uint32> WhiteItemsBin;
-    std::set<uint32> GreenItemsBin;
-    std::set<uint32> BlueItemsBin;
-    std::set<uint32> PurpleItemsBin;
-    std::set<uint32> OrangeItemsBin;
-    std::set<uint32> YellowItemsBin;
+    std::vector<AHBListing> GreyItemsBin;
+    std::vector<AHBListing> WhiteItemsBin;
+    std::vector<AHBListing> GreenItemsBin;
+    std::vector<AHBListing> BlueItemsBin;
+    std::vector<AHBListing> PurpleItemsBin;
+    std::vector<AHBListing> OrangeItemsBin;
+    std::vector<AHBListing> YellowItemsBin;
 
     //
     // Constructors/destructors
@@ -300,10 +413,14 @@ public:
     // Ruotines
     //
 
-    void   Initialize(std::set<uint32> botsIds);
+    void   Initialize(std::set<uint32> botsIds, AHBHousesSettings const& houses, std::shared_ptr<AHBItemSources const> sources);
+    void   PrepareBins   (uint32 slices, std::vector<std::function<void()>>& tasks, AHBBinCache const* cache);
     void   InitializeBins();
+    uint64 GetBinsHash   ();
     void   Reset();
 
+    static void LoadHousesSettings(AHBHousesSettings& houses);
+
     uint32 GetAHID();
     uint32 GetAHFID();
 
@@ -344,6 +461,8 @@ public:
     void   CalculatePercents ();
     uint32 GetMaximum        (uint32 color);
 
+    std::vector<AHBListing> const& GetBin(uint32 color);
+
     void   DecItemCounts     (uint32 Class, uint32 Quality);
     void   DecItemCounts     (uint32 color);
 
@@ -355,6 +474,31 @@ public:
 
     uint32 GetItemCounts     (uint32 color);
 
+    void   IncBotItemCounts  (uint32 botId, uint32 itemId);
+    void   DecBotItemCounts  (uint32 botId, uint32 itemId);
+    uint32 GetBotItemCounts  (uint32 botId, uint32 itemId);
+
+    void   IncBotAuctionCounts(uint32 botId);
+    void   DecBotAuctionCounts(uint32 botId);
+    uint32 GetBotAuctionCounts(uint32 botId);
+
+    void   AddBuyerCandidate   (AuctionEntry* auction);
+    void   RemoveBuyerCandidate(uint32 auctionId);
+    void   UpdateBuyerCandidate(AuctionEntry* auction);
+    void   SampleBuyerCandidates(uint32 count, ObjectGuid bidder, std::vector<uint32>& picks);
+    void   SelectBuyerDeals    (uint32 count, ObjectGuid bidder, std::vector<uint32>& picks);
+    void   SelectBuyerExpiries (uint32 count, ObjectGuid bidder, std::vector<uint32>& picks);
+
+    void   AddSellerExpiry     (AuctionEntry* auction);
+    void   RemoveSellerExpiry  (uint32 auctionId);
+    uint32 CountSellerExpiries (time_t until);
+
+    void   SleepSeller         (uint32 botId);
+    bool   IsSellerDormant     (uint32 botId);
+    void   WakeSellers         ();
+
+    std::vector<uint32> const& GetBuyerCandidates();
+
     void   UpdateItemStats   (uint32 id, uint32 stackSize, uint64 buyout);
     uint64 GetItemPrice      (uint32 id);
 };
@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "DatabaseEnv.h"
+#include "ItemTemplate.h"
+#include "Log.h"
+#include "ObjectMgr.h"
+
+#include "AuctionHouseBotBinCache.h"
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotItemSources.h"
+
+AHBItemSources::AHBItemSources()
+{
+}
+
+AHBItemSources::~AHBItemSources()
+{
+}
+
+void AHBItemSources::Load(bool debug, AHBBinCache* cache)
+{
+    //
+    // The ids of the sources are taken from the cache when the tables did not change since it was written
+    //
+
+    if (cache && cache->GetSources(_npcItems, _lootItems, _disabledItems))
+    {
+        if (debug)
+        {
+            LOG_INFO("module", "Loaded {} disabled, {} NPC and {} lootable items from the bins cache", uint32(_disabledItems.size()), uint32(_npcItems.size()), uint32(_lootItems.size()));
+        }
+    }
+    else
+    {
+        loadSources(debug);
+
+        if (cache)
+        {
+            cache->SetSources(_npcItems, _lootItems, _disabledItems);
+        }
+    }
+
+    //
+    // Features of the templates, once the sources are known
+    //
+
+    loadFeatures();
+
+    if (debug)
+    {
+        LOG_INFO("module", "Described {} sellable item templates", GetTemplateCount());
+    }
+}
+
+void AHBItemSources::loadSources(bool debug)
+{
+    //
+    // Disabled items
+    //
+
+    loadItems("SELECT item FROM mod_auctionhousebot_disabled_items", _disabledItems);
+
+    if (debug)
+    {
+        LOG_INFO("module", "Loaded {} items from the disabled item store", uint32(_disabledItems.size()));
+    }
+
+    //
+    // Items sold by the vendors
+    //
+
+    if (!loadItems("SELECT distinct item FROM npc_vendor", _npcItems) && debug)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: failed to retrieve npc items");
+    }
+
+    if (debug)
+    {
+        LOG_INFO("module", "Loaded {} items from NPCs", uint32(_npcItems.size()));
+    }
+
+    //
+    // Lootable items
+    //
+
+    bool loot = loadItems(
+        "SELECT item FROM creature_loot_template      UNION "
+        "SELECT item FROM reference_loot_template     UNION "
+        "SELECT item FROM disenchant_loot_template    UNION "
+        "SELECT item FROM fishing_loot_template       UNION "
+        "SELECT item FROM gameobject_loot_template    UNION "
+        "SELECT item FROM item_loot_template          UNION "
+        "SELECT item FROM milling_loot_template       UNION "
+        "SELECT item FROM pickpocketing_loot_template UNION "
+        "SELECT item FROM prospecting_loot_template   UNION "
+        "SELECT item FROM skinning_loot_template", _lootItems);
+
+    if (!loot && debug)
+    {
+        LOG_ERROR("module", "AuctionHouseBot: failed to retrieve loot items");
+    }
+
+    if (debug)
+    {
+        LOG_INFO("module", "Loaded {} items from lootable items", uint32(_lootItems.size()));
+    }
+}
+
+uint64 AHBItemSources::GetFingerprint()
+{
+    //
+    // The item templates are already in memory: every field used by the filters and the listings is hashed,
+    // and the hashes are added so that the order of the store does not matter
+    //
+
+    uint64 templates = 0;
+
+    ItemTemplateContainer const* its = sObjectMgr->GetItemTemplateStore();
+
+    for (ItemTemplateContainer::const_iterator itr = its->begin(); itr != its->end(); ++itr)
+    {
+        ItemTemplate const& proto = itr->second;
+
+        uint64 hash = AHBBinCache::HashSeed;
+
+        hash = AHBBinCache::Hash(hash, uint32(proto.ItemId));
+        hash = AHBBinCache::Hash(hash, uint32(proto.Class));
+        hash = AHBBinCache::Hash(hash, uint32(proto.Quality));
+        hash = AHBBinCache::Hash(hash, uint32(proto.Flags));
+        hash = AHBBinCache::Hash(hash, int64(proto.BuyPrice));
+        hash = AHBBinCache::Hash(hash, uint32(proto.SellPrice));
+        hash = AHBBinCache::Hash(hash, int32(proto.AllowableClass));
+        hash = AHBBinCache::Hash(hash, uint32(proto.ItemLevel));
+        hash = AHBBinCache::Hash(hash, uint32(proto.RequiredLevel));
+        hash = AHBBinCache::Hash(hash, uint32(proto.RequiredSkillRank));
+        hash = AHBBinCache::Hash(hash, uint32(proto.GetMaxStackSize()));
+        hash = AHBBinCache::Hash(hash, uint32(proto.Bonding));
+        hash = AHBBinCache::Hash(hash, uint32(proto.MinMoneyLoot));
+        hash = AHBBinCache::Hash(hash, uint32(proto.Duration));
+        hash = AHBBinCache::Hash(hash, uint32(proto.RandomProperty));
+        hash = AHBBinCache::Hash(hash, uint32(proto.RandomSuffix));
+        hash = AHBBinCache::Hash(hash, bool(proto.IsConjuredConsumable()));
+
+        templates += hash;
+    }
+
+    uint64 fingerprint = AHBBinCache::Hash(AHBBinCache::HashSeed, templates);
+
+    //
+    // The tables of the sources are checksummed by the database, without transferring them
+    //
+
+    QueryResult result = WorldDatabase.Query(
+        "CHECKSUM TABLE mod_auctionhousebot_disabled_items, npc_vendor, "
+        "creature_loot_template, reference_loot_template, disenchant_loot_template, fishing_loot_template, gameobject_loot_template, "
+        "item_loot_template, milling_loot_template, pickpocketing_loot_template, prospecting_loot_template, skinning_loot_template");
+
+    if (!result)
+    {
+        return 0; // No fingerprint, no cache
+    }
+
+    do
+    {
+        Field*      fields = result->Fetch();
+        std::string table  = fields[0].Get<std::string>();
+
+        fingerprint = AHBBinCache::Hash(fingerprint, table.data(), table.size());
+        fingerprint = AHBBinCache::Hash(fingerprint, fields[1].Get<uint64>());
+    } while (result->NextRow());
+
+    return fingerprint;
+}
+
+void AHBItemSources::loadFeatures()
+{
+    _templates.clear();
+    _itemIds.clear();
+    _features.clear();
+    _itemLevels.clear();
+    _reqLevels.clear();
+    _skillRanks.clear();
+
+    ItemTemplateContainer const* its = sObjectMgr->GetItemTemplateStore();
+
+    _templates.reserve(its->size());
+    _itemIds.reserve(its->size());
+    _features.reserve(its->size());
+    _itemLevels.reserve(its->size());
+    _reqLevels.reserve(its->size());
+    _skillRanks.reserve(its->size());
+
+    for (ItemTemplateContainer::const_iterator itr = its->begin(); itr != its->end(); ++itr)
+    {
+        ItemTemplate const& proto = itr->second;
+
+        //
+        // Items without any price or above the limit quality are never sold, whatever the configuration
+        //
+
+        if ((proto.BuyPrice == 0 && proto.SellPrice == 0) || proto.Quality > AHB_MAX_QUALITY)
+        {
+            continue;
+        }
+
+        uint32 features = 0;
+
+        switch (proto.Bonding)
+        {
+        case NO_BIND:
+            features |= AHB_FEATURE_NO_BIND;
+            break;
+
+        case BIND_WHEN_PICKED_UP:
+            features |= AHB_FEATURE_BIND_PICKED_UP;
+            break;
+
+        case BIND_WHEN_EQUIPPED:
+            features |= AHB_FEATURE_BIND_EQUIPPED;
+            break;
+
+        case BIND_WHEN_USE:
+            features |= AHB_FEATURE_BIND_USE;
+            break;
+
+        case BIND_QUEST_ITEM:
+            features |= AHB_FEATURE_BIND_QUEST;
+            break;
+        }
+
+        if (proto.BuyPrice != 0)
+        {
+            features |= AHB_FEATURE_BUY_PRICE;
+        }
+
+        if (proto.SellPrice != 0)
+        {
+            features |= AHB_FEATURE_SELL_PRICE;
+        }
+
+        if (proto.Class == ITEM_CLASS_TRADE_GOODS)
+        {
+            features |= AHB_FEATURE_TRADE_GOODS;
+        }
+
+        //
+        // An item sold by a vendor is filtered as such even when it is looted too
+        //
+
+        if (IsNpcItem(proto.ItemId))
+        {
+            features |= AHB_FEATURE_VENDOR;
+        }
+
+        if (IsLootItem(proto.ItemId))
+        {
+            features |= AHB_FEATURE_LOOT;
+        }
+
+        if (!(features & (AHB_FEATURE_VENDOR | AHB_FEATURE_LOOT)))
+        {
+            features |= AHB_FEATURE_OTHER;
+        }
+
+        if (IsDisabled(proto.ItemId))
+        {
+            features |= AHB_FEATURE_DISABLED;
+        }
+
+        if (proto.Class == ITEM_CLASS_PERMANENT)
+        {
+            features |= AHB_FEATURE_PERM_ENCHANT;
+        }
+
+        if (proto.IsConjuredConsumable())
+        {
+            features |= AHB_FEATURE_CONJURED;
+        }
+
+        if (proto.Class == ITEM_CLASS_GEM)
+        {
+            features |= AHB_FEATURE_GEM;
+        }
+
+        if (proto.Class == ITEM_CLASS_MONEY)
+        {
+            features |= AHB_FEATURE_MONEY;
+        }
+
+        if (proto.MinMoneyLoot > 0)
+        {
+            features |= AHB_FEATURE_MONEY_LOOT;
+        }
+
+        if (proto.Flags & 4)
+        {
+            features |= AHB_FEATURE_LOOTABLE;
+        }
+
+        if (proto.Class == ITEM_CLASS_KEY)
+        {
+            features |= AHB_FEATURE_KEY;
+        }
+
+        if (proto.Duration > 0)
+        {
+            features |= AHB_FEATURE_DURATION;
+        }
+
+        if ((proto.Bonding == BIND_WHEN_PICKED_UP || proto.Bonding == BIND_QUEST_ITEM) && proto.RequiredLevel < proto.ItemLevel)
+        {
+            features |= AHB_FEATURE_BOP_NO_REQ_LEVEL;
+        }
+
+        //
+        // Only the items usable by exactly one class are filtered by class
+        //
+
+        if (proto.AllowableClass > 0 && proto.AllowableClass <= AHB_CLASS_DRUID && (proto.AllowableClass & (proto.AllowableClass - 1)) == 0)
+        {
+            features |= AHB_FEATURE_CLASS_WARRIOR * uint32(proto.AllowableClass);
+        }
+
+        _templates.push_back(&proto);
+        _itemIds.push_back(proto.ItemId);
+        _features.push_back(features);
+        _itemLevels.push_back(clampLevel(proto.ItemLevel));
+        _reqLevels.push_back(clampLevel(proto.RequiredLevel));
+        _skillRanks.push_back(clampLevel(proto.RequiredSkillRank));
+    }
+
+    _templates.shrink_to_fit();
+    _itemIds.shrink_to_fit();
+    _features.shrink_to_fit();
+    _itemLevels.shrink_to_fit();
+    _reqLevels.shrink_to_fit();
+    _skillRanks.shrink_to_fit();
+}
+
+bool AHBItemSources::loadItems(std::string const& query, std::vector<uint32>& items)
+{
+    items.clear();
+
+    QueryResult result = WorldDatabase.Query(query);
+
+    if (!result)
+    {
+        return false;
+    }
+
+    items.reserve(result->GetRowCount());
+
+    do
+    {
+        Field* fields = result->Fetch();
+        items.push_back(fields[0].Get<uint32>());
+    } while (result->NextRow());
+
+    //
+    // Sorted and without duplicates, for the binary search
+    //
+
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+    items.shrink_to_fit();
+
+    return true;
+}
+
+uint16 AHBItemSources::clampLevel(uint32 value)
+{
+    return value < 0xFFFF ? uint16(value) : uint16(0xFFFF);
+}
+
+bool AHBItemSources::contains(std::vector<uint32> const& items, uint32 itemId)
+{
+    return std::binary_search(items.begin(), items.end(), itemId);
+}
+
+bool AHBItemSources::IsNpcItem(uint32 itemId) const
+{
+    return contains(_npcItems, itemId);
+}
+
+bool AHBItemSources::IsLootItem(uint32 itemId) const
+{
+    return contains(_lootItems, itemId);
+}
+
+bool AHBItemSources::IsDisabled(uint32 itemId) const
+{
+    return contains(_disabledItems, itemId);
+}
+
+uint32 AHBItemSources::GetDisabledCount() const
+{
+    return _disabledItems.size();
+}
+
+uint32 AHBItemSources::GetTemplateCount() const
+{
+    return _templates.size();
+}
+
+ItemTemplate const* AHBItemSources::GetTemplate(uint32 index) const
+{
+    return _templates[index];
+}
+
+uint32 AHBItemSources::GetFeatures(uint32 index) const
+{
+    return _features[index];
+}
+
+void AHBItemSources::Filter(AHBItemFilter const& items, AHBItemFilter const& tradeGoods, uint32 first, uint32 last, std::vector<uint32>& passed, std::vector<uint32>* rejected) const
+{
+    passed.clear();
+
+    uint32 const  end        = std::min<uint32>(last, _templates.size());
+    uint32 const* itemIds    = _itemIds.data();
+    uint32 const* features   = _features.data();
+    uint16 const* itemLevels = _itemLevels.data();
+    uint16 const* reqLevels  = _reqLevels.data();
+    uint16 const* skillRanks = _skillRanks.data();
+
+    for (uint32 index = first; index < end; ++index)
+    {
+        AHBItemFilter const& filter = (features[index] & AHB_FEATURE_TRADE_GOODS) ? tradeGoods : items;
+
+        //
+        // Every test is evaluated, without branches, the result is only checked at the end
+        //
+
+        bool pass = ((features[index] & filter.Excluded) == 0)
+                  & ((features[index] & filter.Required) == filter.Required)
+                  & (itemLevels[index] >= filter.MinItemLevel) & (itemLevels[index] <= filter.MaxItemLevel)
+                  & (itemIds[index]    >= filter.MinItemId)    & (itemIds[index]    <= filter.MaxItemId)
+                  & (reqLevels[index]  >= filter.MinReqLevel)  & (reqLevels[index]  <= filter.MaxReqLevel)
+                  & (skillRanks[index] >= filter.MinSkillRank) & (skillRanks[index] <= filter.MaxSkillRank);
+
+        if (pass)
+        {
+            passed.push_back(index);
+        }
+        else if (rejected)
+        {
+            rejected->push_back(index);
+        }
+    }
+}
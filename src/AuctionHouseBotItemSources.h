@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_ITEM_SOURCES_H
+#define AUCTION_HOUSE_BOT_ITEM_SOURCES_H
+
+#include <string>
+#include <vector>
+
+#include "Common.h"
+
+class  AHBBinCache;
+struct ItemTemplate;
+
+//
+// Properties of an item template tested by the seller filters, one bit each
+//
+
+#define AHB_FEATURE_NO_BIND          0x00000001
+#define AHB_FEATURE_BIND_PICKED_UP   0x00000002
+#define AHB_FEATURE_BIND_EQUIPPED    0x00000004
+#define AHB_FEATURE_BIND_USE         0x00000008
+#define AHB_FEATURE_BIND_QUEST       0x00000010
+#define AHB_FEATURE_BUY_PRICE        0x00000020  // BuyPrice is not 0
+#define AHB_FEATURE_SELL_PRICE       0x00000040  // SellPrice is not 0
+#define AHB_FEATURE_TRADE_GOODS      0x00000080
+#define AHB_FEATURE_VENDOR           0x00000100  // Sold by a vendor
+#define AHB_FEATURE_LOOT             0x00000200  // Dropped as loot
+#define AHB_FEATURE_OTHER            0x00000400  // Neither sold nor looted
+#define AHB_FEATURE_DISABLED         0x00000800
+#define AHB_FEATURE_PERM_ENCHANT     0x00001000
+#define AHB_FEATURE_CONJURED         0x00002000
+#define AHB_FEATURE_GEM              0x00004000
+#define AHB_FEATURE_MONEY            0x00008000
+#define AHB_FEATURE_MONEY_LOOT       0x00010000
+#define AHB_FEATURE_LOOTABLE         0x00020000
+#define AHB_FEATURE_KEY              0x00040000
+#define AHB_FEATURE_DURATION         0x00080000
+#define AHB_FEATURE_BOP_NO_REQ_LEVEL 0x00100000  // BOP or quest item with a required level lower than the item level
+
+//
+// Usable by a single class: the AHB_CLASS_* value times AHB_FEATURE_CLASS_WARRIOR
+//
+
+#define AHB_FEATURE_CLASS_WARRIOR    0x00200000
+#define AHB_FEATURE_CLASS_PALADIN    0x00400000
+#define AHB_FEATURE_CLASS_HUNTER     0x00800000
+#define AHB_FEATURE_CLASS_ROGUE      0x01000000
+#define AHB_FEATURE_CLASS_PRIEST     0x02000000
+#define AHB_FEATURE_CLASS_DK         0x04000000
+#define AHB_FEATURE_CLASS_SHAMAN     0x08000000
+#define AHB_FEATURE_CLASS_MAGE       0x10000000
+#define AHB_FEATURE_CLASS_WARLOCK    0x20000000
+#define AHB_FEATURE_CLASS_UNUSED     0x40000000
+#define AHB_FEATURE_CLASS_DRUID      0x80000000
+
+//
+// Filter of an auction house for one kind of items (trade goods or the others).
+// The ranges are inclusive; a disabled bound is 0 or 0xFFFFFFFF.
+//
+
+struct AHBItemFilter
+{
+    uint32 Required;     // Features the item must have
+    uint32 Excluded;     // Features the item must not have
+
+    uint32 MinItemLevel;
+    uint32 MaxItemLevel;
+    uint32 MinItemId;
+    uint32 MaxItemId;
+    uint32 MinReqLevel;
+    uint32 MaxReqLevel;
+    uint32 MinSkillRank;
+    uint32 MaxSkillRank;
+
+    AHBItemFilter() : Required(0), Excluded(0),
+        MinItemLevel(0), MaxItemLevel(0xFFFFFFFF), MinItemId(0), MaxItemId(0xFFFFFFFF),
+        MinReqLevel(0), MaxReqLevel(0xFFFFFFFF), MinSkillRank(0), MaxSkillRank(0xFFFFFFFF) { }
+};
+
+// =============================================================================
+// Where the items come from: sold by the vendors, dropped as loot, or disabled
+// for the bots. Loaded once from the world database for all the auction houses
+// and never changed afterwards; a reload builds a new catalog.
+// The ids are kept in sorted arrays and looked up by binary search, and can be
+// restored from the bins cache instead of the database.
+//
+// The catalog also describes every item template that can be sold at all, as
+// parallel arrays of features and levels, so that each auction house builds its
+// bins with a single scan instead of testing the templates one option at a time.
+// =============================================================================
+
+class AHBItemSources
+{
+private:
+    std::vector<uint32> _npcItems;
+    std::vector<uint32> _lootItems;
+    std::vector<uint32> _disabledItems;
+
+    //
+    // Sellable templates, one entry per template in each array
+    //
+
+    std::vector<ItemTemplate const*> _templates;
+    std::vector<uint32>              _itemIds;
+    std::vector<uint32>              _features;
+    std::vector<uint16>              _itemLevels;
+    std::vector<uint16>              _reqLevels;
+    std::vector<uint16>              _skillRanks;
+
+    void   loadSources (bool debug);
+    void   loadFeatures();
+
+    static bool   loadItems  (std::string const& query, std::vector<uint32>& items);
+    static bool   contains   (std::vector<uint32> const& items, uint32 itemId);
+    static uint16 clampLevel (uint32 value);
+
+public:
+    AHBItemSources();
+    ~AHBItemSources();
+
+    void   Load(bool debug, AHBBinCache* cache);
+
+    static uint64 GetFingerprint();
+
+    bool   IsNpcItem         (uint32 itemId) const;
+    bool   IsLootItem        (uint32 itemId) const;
+    bool   IsDisabled        (uint32 itemId) const;
+
+    uint32 GetDisabledCount  () const;
+
+    //
+    // Feature scan, by index in [0, GetTemplateCount()); the ranges of indexes can be scanned concurrently
+    //
+
+    uint32              GetTemplateCount() const;
+    ItemTemplate const* GetTemplate     (uint32 index) const;
+    uint32              GetFeatures     (uint32 index) const;
+
+    void                Filter(AHBItemFilter const& items, AHBItemFilter const& tradeGoods, uint32 first, uint32 last, std::vector<uint32>& passed, std::vector<uint32>* rejected) const;
+};
+
+#endif // AUCTION_HOUSE_BOT_ITEM_SOURCES_H
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <cstdio>
+#include <fstream>
+
+#include "Log.h"
+#include "StringFormat.h"
+
+#include "AuctionHouseBot.h"
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotMetrics.h"
+
+AHBMetrics::AHBMetrics()
+{
+    _ready      = false;
+    _running    = false;
+    _stopping   = false;
+    _interval   = 0;
+    _lastExport = 0;
+}
+
+AHBMetrics::~AHBMetrics()
+{
+    Stop();
+}
+
+void AHBMetrics::Start(std::string const& path, uint32 interval)
+{
+    Stop();
+
+    if (path.empty())
+    {
+        return;
+    }
+
+    _path       = path;
+    _interval   = interval > 0 ? interval : 1;
+    _lastExport = 0;
+    _ready      = false;
+    _stopping   = false;
+    _running    = true;
+    _worker     = std::thread(&AHBMetrics::Run, this);
+}
+
+void AHBMetrics::Stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+
+    _wakeup.notify_all();
+    _worker.join();
+
+    _running = false;
+}
+
+bool AHBMetrics::IsRunning()
+{
+    return _running;
+}
+
+void AHBMetrics::Update()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    time_t now = time(NULL);
+
+    if (now - _lastExport < time_t(_interval))
+    {
+        return;
+    }
+
+    _lastExport = now;
+
+    //
+    // Prepare the text here, where the bots can be safely read, and leave the disk to the writer
+    //
+
+    std::string text;
+    render(text);
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        _pending = std::move(text);
+        _ready   = true;
+    }
+
+    _wakeup.notify_one();
+}
+
+void AHBMetrics::Run()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+
+    while (true)
+    {
+        _wakeup.wait(guard, [this] { return _stopping || _ready; });
+
+        if (_stopping)
+        {
+            break;
+        }
+
+        std::string text = std::move(_pending);
+        _ready = false;
+
+        guard.unlock();
+        write(_path, text);
+        guard.lock();
+    }
+}
+
+void AHBMetrics::write(std::string const& path, std::string const& text)
+{
+    //
+    // Write aside and rename, so that the collector never reads a partial file
+    //
+
+    std::string   temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+
+    if (!file)
+    {
+        LOG_ERROR("module", "AHBot: cannot write the metrics file {}", temporary);
+        return;
+    }
+
+    file << text;
+    file.close();
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR("module", "AHBot: cannot replace the metrics file {}", path);
+    }
+}
+
+void AHBMetrics::renderHistogram(std::string& text, std::string const& name, std::string const& labels, AHBHistogram& histogram)
+{
+    //
+    // The n-th bucket holds the durations below 2^n microseconds; the last one holds everything else
+    //
+
+    uint64 cumulative = 0;
+
+    for (uint32 bucket = 0; bucket < AHB_HISTOGRAM_BUCKETS - 1; ++bucket)
+    {
+        cumulative += histogram.GetBucket(bucket);
+
+        text += Acore::StringFormat("{}_bucket{{{},le=\"{}\"}} {}\n", name, labels, (uint64(1) << bucket) - 1, cumulative);
+    }
+
+    text += Acore::StringFormat("{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels, histogram.GetCount());
+    text += Acore::StringFormat("{}_sum{{{}}} {}\n"               , name, labels, histogram.GetTotal());
+    text += Acore::StringFormat("{}_count{{{}}} {}\n"             , name, labels, histogram.GetCount());
+}
+
+void AHBMetrics::render(std::string& text)
+{
+    static uint32      const houseIds  [AHB_STATS_HOUSES] = { 2, 6, 7 };
+    static char const* const houseNames[AHB_STATS_HOUSES] = { "alliance", "horde", "neutral" };
+    static char const* const phaseNames[AHB_PHASES]       = { "update", "sell", "buy", "plan", "create", "flush" };
+
+    static char const* const outcomeNames[AHB_COUNTERS]   = { "sold", "bin_empty", "no_need", "too_many", "loop_break", "error", "bid", "buyout" };
+
+    static char const* const categoryNames[AHB_CATEGORIES] =
+    {
+        "grey_tg", "white_tg", "green_tg", "blue_tg", "purple_tg", "orange_tg", "yellow_tg",
+        "grey_i" , "white_i" , "green_i" , "blue_i" , "purple_i" , "orange_i" , "yellow_i"
+    };
+
+    AHBConfig* configs[AHB_STATS_HOUSES] = { gAllianceConfig, gHordeConfig, gNeutralConfig };
+
+    //
+    // Timings
+    //
+
+    text += "# HELP ahbot_update_duration_microseconds Duration of the updates of a bot.\n";
+    text += "# TYPE ahbot_update_duration_microseconds histogram\n";
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        renderHistogram(text, "ahbot_update_duration_microseconds", Acore::StringFormat("bot=\"{}\"", bot->GetAHBplayerGUID()), bot->GetStats().GetUpdate());
+    }
+
+    text += "# HELP ahbot_phase_duration_microseconds Duration of the phases of a bot, by auction house.\n";
+    text += "# TYPE ahbot_phase_duration_microseconds histogram\n";
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        for (uint32 house = 0; house < AHB_STATS_HOUSES; ++house)
+        {
+            for (uint32 phase = AHB_PHASE_SELL; phase < AHB_PHASES; ++phase)
+            {
+                std::string labels = Acore::StringFormat("bot=\"{}\",house=\"{}\",phase=\"{}\"", bot->GetAHBplayerGUID(), houseNames[house], phaseNames[phase]);
+
+                renderHistogram(text, "ahbot_phase_duration_microseconds", labels, bot->GetStats().Get(houseIds[house], AHBPhase(phase)));
+            }
+        }
+    }
+
+    //
+    // Outcomes of the sellers and of the buyers
+    //
+
+    text += "# HELP ahbot_operations_total Outcomes of the listings and of the bids of a bot, by auction house.\n";
+    text += "# TYPE ahbot_operations_total counter\n";
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        for (uint32 house = 0; house < AHB_STATS_HOUSES; ++house)
+        {
+            for (uint32 counter = 0; counter < AHB_COUNTERS; ++counter)
+            {
+                text += Acore::StringFormat("ahbot_operations_total{{bot=\"{}\",house=\"{}\",outcome=\"{}\"}} {}\n", bot->GetAHBplayerGUID(), houseNames[house], outcomeNames[counter],
+                    bot->GetStats().Get(houseIds[house], AHBCounter(counter)));
+            }
+        }
+    }
+
+    //
+    // Items the sellers can choose from
+    //
+
+    text += "# HELP ahbot_bin_items Items available to the sellers, by auction house and category.\n";
+    text += "# TYPE ahbot_bin_items gauge\n";
+
+    for (uint32 house = 0; house < AHB_STATS_HOUSES; ++house)
+    {
+        for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+        {
+            text += Acore::StringFormat("ahbot_bin_items{{house=\"{}\",category=\"{}\"}} {}\n", houseNames[house], categoryNames[category], configs[house]->GetBin(category).size());
+        }
+    }
+}
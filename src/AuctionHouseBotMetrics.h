@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_METRICS_H
+#define AUCTION_HOUSE_BOT_METRICS_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Common.h"
+
+#include "AuctionHouseBotStats.h"
+
+// =============================================================================
+// Exports the statistics of the bots to a file in the Prometheus text format, to be
+// picked up by the textfile collector of the node exporter. The text is prepared on the
+// world thread, which owns the bots, and written to the disk by a separate thread.
+// =============================================================================
+
+class AHBMetrics
+{
+private:
+    std::thread             _worker;
+    std::mutex              _lock;
+    std::condition_variable _wakeup;   // A text is ready or the writer is stopping
+    std::string             _path;
+    std::string             _pending;  // Text waiting to be written
+    bool                    _ready;
+    bool                    _running;
+    bool                    _stopping;
+    uint32                  _interval; // Seconds between two exports
+    time_t                  _lastExport;
+
+    void Run();
+
+    static void write          (std::string const& path, std::string const& text);
+    static void render         (std::string& text);
+    static void renderHistogram(std::string& text, std::string const& name, std::string const& labels, AHBHistogram& histogram);
+
+public:
+    AHBMetrics();
+    ~AHBMetrics();
+
+    void Start    (std::string const& path, uint32 interval);
+    void Stop     ();
+    bool IsRunning();
+
+    void Update   ();
+};
+
+extern AHBMetrics gMetrics;
+
+#endif // AUCTION_HOUSE_BOT_METRICS_H
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "Random.h"
+
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotSampler.h"
+
+AHBPlanner::AHBPlanner()
+{
+    _running  = false;
+    _stopping = false;
+    _busy     = false;
+}
+
+AHBPlanner::~AHBPlanner()
+{
+    Stop();
+}
+
+void AHBPlanner::Start()
+{
+    if (_running)
+    {
+        return;
+    }
+
+    _stopping = false;
+    _running  = true;
+    _worker   = std::thread(&AHBPlanner::Run, this);
+}
+
+void AHBPlanner::Stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+
+    _wakeup.notify_all();
+    _worker.join();
+
+    _running = false;
+
+    _requests.clear();
+    _plans.clear();
+}
+
+void AHBPlanner::Flush()
+{
+    //
+    // Wait for the request in progress, then forget everything: the plans point into the bins,
+    // which are about to be filled again
+    //
+
+    std::unique_lock<std::mutex> guard(_lock);
+
+    _requests.clear();
+    _finished.wait(guard, [this] { return !_busy; });
+    _plans.clear();
+}
+
+bool AHBPlanner::IsRunning()
+{
+    return _running;
+}
+
+void AHBPlanner::Submit(AHBPlanRequest const& request)
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        //
+        // One request at a time for each bot and auction house, and only when the ready listings are running low
+        //
+
+        for (AHBPlanRequest const& queued: _requests)
+        {
+            if (queued.BotId == request.BotId && queued.AHID == request.AHID)
+            {
+                return;
+            }
+        }
+
+        std::map<PlanKey, PlanQueue>::const_iterator itr = _plans.find(PlanKey(request.BotId, request.AHID));
+
+        if (itr != _plans.end() && itr->second.size() >= request.Count)
+        {
+            return;
+        }
+
+        _requests.push_back(request);
+    }
+
+    _wakeup.notify_one();
+}
+
+bool AHBPlanner::Next(uint32 botId, uint32 ahid, AHBPlannedListing& plan)
+{
+    if (!_running)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    std::map<PlanKey, PlanQueue>::iterator itr = _plans.find(PlanKey(botId, ahid));
+
+    if (itr == _plans.end() || itr->second.empty())
+    {
+        return false;
+    }
+
+    plan = itr->second.front();
+    itr->second.pop_front();
+
+    return true;
+}
+
+void AHBPlanner::Run()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+
+    while (true)
+    {
+        _wakeup.wait(guard, [this] { return _stopping || !_requests.empty(); });
+
+        if (_stopping)
+        {
+            break;
+        }
+
+        AHBPlanRequest request = _requests.front();
+        _requests.pop_front();
+
+        _busy = true;
+
+        //
+        // Plan without holding the lock, so that the world thread is never kept waiting
+        //
+
+        guard.unlock();
+
+        PlanQueue plans;
+        Plan(request, plans);
+
+        guard.lock();
+
+        PlanQueue& ready = _plans[PlanKey(request.BotId, request.AHID)];
+        ready.insert(ready.end(), plans.begin(), plans.end());
+
+        _busy = false;
+        _finished.notify_all();
+    }
+
+    _busy = false;
+    _finished.notify_all();
+}
+
+void AHBPlanner::Plan(AHBPlanRequest const& request, std::deque<AHBPlannedListing>& plans)
+{
+    //
+    // Categories with an empty bin cannot be selected
+    //
+
+    std::vector<uint32> weights(request.Weights, request.Weights + AHB_CATEGORIES);
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; ++category)
+    {
+        if (request.Config->GetBin(category).empty())
+        {
+            weights[category] = 0;
+        }
+    }
+
+    AHBSampler sampler;
+    sampler.Build(weights);
+
+    for (uint32 cnt = 0; cnt < request.Count && !sampler.Empty(); ++cnt)
+    {
+        uint32                         category = sampler.Sample();
+        std::vector<AHBListing> const& bin      = request.Config->GetBin(category);
+
+        AHBPlannedListing plan;
+
+        plan.Listing = &bin[urand(0, bin.size() - 1)];
+
+        uint32 quality   = plan.Listing->Quality;
+        uint32 maxStack  = plan.Listing->MaxStack;
+
+        plan.PriceFactor = urand(request.MinPrices[quality], request.MaxPrices[quality]);
+        plan.BidFactor   = urand(request.MinBidPrices[quality], request.MaxBidPrices[quality]);
+
+        if (request.MaxStacks[quality] > 1 && maxStack > 1)
+        {
+            plan.StackCount = std::min(getStackCount(request.DivisibleStacks, maxStack), request.MaxStacks[quality]);
+        }
+        else if (request.MaxStacks[quality] == 0 && maxStack > 1)
+        {
+            plan.StackCount = getStackCount(request.DivisibleStacks, maxStack);
+        }
+        else
+        {
+            plan.StackCount = 1;
+        }
+
+        plan.ElapsedTime = getElapsedTime(request.ElapsingTimeClass);
+
+        plans.push_back(plan);
+
+        //
+        // Every listing uses a unit of the weight of its category
+        //
+
+        if (--weights[category] == 0)
+        {
+            sampler.Build(weights);
+        }
+    }
+}
+
+uint32 AHBPlanner::getStackCount(bool divisible, uint32 max)
+{
+    if (max == 1)
+    {
+        return 1;
+    }
+
+    //
+    // Organize the stacks in a pseudo random way
+    //
+
+    if (divisible)
+    {
+        uint32 ret = 0;
+
+        if (max % 5 == 0) // 5, 10, 15, 20
+        {
+            ret = urand(1, 4) * 5;
+        }
+
+        if (max % 4 == 0) // 4, 8, 12, 16
+        {
+            ret = urand(1, 4) * 4;
+        }
+
+        if (max % 3 == 0) // 3, 6, 9, 18
+        {
+            ret = urand(1, 3) * 3;
+        }
+
+        if (ret > max)
+        {
+            ret = max;
+        }
+
+        return ret;
+    }
+
+    //
+    // Totally random
+    //
+
+    return urand(1, max);
+}
+
+uint32 AHBPlanner::getElapsedTime(uint32 timeClass)
+{
+    switch (timeClass)
+    {
+    case 2:
+        return urand(1, 5) * 600;   // SHORT = In the range of one hour
+
+    case 1:
+        return urand(1, 23) * 3600; // MEDIUM = In the range of one day
+
+    default:
+        return urand(1, 3) * 86400; // LONG = More than one day but less than three
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_PLANNER_H
+#define AUCTION_HOUSE_BOT_PLANNER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Common.h"
+
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotConfig.h"
+
+//
+// A listing decided in advance: what is sold, at which price, in which amount and for how long
+//
+
+struct AHBPlannedListing
+{
+    AHBListing const* Listing;     // Entry of a bin; valid until the bins are filled again
+    uint32            PriceFactor; // Percentage of the base price asked as buyout
+    uint32            BidFactor;   // Percentage of the buyout asked as starting bid
+    uint32            StackCount;
+    uint32            ElapsedTime;
+};
+
+//
+// Snapshot of the configuration of an auction house, taken on the world thread, used to plan the listings
+//
+
+struct AHBPlanRequest
+{
+    uint32     BotId;
+    uint32     AHID;
+    AHBConfig* Config;                             // Only the bins are read from it
+    uint32     Count;                              // Listings to plan
+    uint32     Weights     [AHB_CATEGORIES];       // Relative frequency of each category
+    uint32     MinPrices   [AHB_MAX_QUALITY + 1];
+    uint32     MaxPrices   [AHB_MAX_QUALITY + 1];
+    uint32     MinBidPrices[AHB_MAX_QUALITY + 1];
+    uint32     MaxBidPrices[AHB_MAX_QUALITY + 1];
+    uint32     MaxStacks   [AHB_MAX_QUALITY + 1];
+    bool       DivisibleStacks;
+    uint32     ElapsingTimeClass;
+};
+
+// =============================================================================
+// Plans the seller listings on a worker thread, ahead of the cycles that use them.
+// The world thread is left with the creation of the items and auctions only.
+// =============================================================================
+
+class AHBPlanner
+{
+private:
+    typedef std::pair<uint32, uint32>      PlanKey;   // Bot id and auction house id
+    typedef std::deque<AHBPlannedListing>  PlanQueue;
+
+    std::thread                            _worker;
+    std::mutex                             _lock;
+    std::condition_variable                _wakeup;   // A request was queued or the planner is stopping
+    std::condition_variable                _finished; // The worker completed a request
+    std::deque<AHBPlanRequest>             _requests;
+    std::map<PlanKey, PlanQueue>           _plans;    // Listings ready to be used
+    bool                                   _running;
+    bool                                   _stopping;
+    bool                                   _busy;
+
+    void Run();
+
+    static uint32 getStackCount (bool divisible, uint32 max);
+    static uint32 getElapsedTime(uint32 timeClass);
+
+public:
+    AHBPlanner();
+    ~AHBPlanner();
+
+    void Start    ();
+    void Stop     ();
+    void Flush    ();
+    bool IsRunning();
+
+    void Submit   (AHBPlanRequest const& request);
+    bool Next     (uint32 botId, uint32 ahid, AHBPlannedListing& plan);
+
+    static void Plan(AHBPlanRequest const& request, std::deque<AHBPlannedListing>& plans);
+};
+
+extern AHBPlanner gPlanner;
+
+#endif // AUCTION_HOUSE_BOT_PLANNER_H
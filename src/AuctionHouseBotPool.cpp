@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include "AuctionHouseBotPool.h"
+
+AHBWorkerPool::AHBWorkerPool()
+{
+    _pending  = 0;
+    _stopping = false;
+}
+
+AHBWorkerPool::~AHBWorkerPool()
+{
+    Stop();
+}
+
+void AHBWorkerPool::Start(uint32 threads)
+{
+    if (!_workers.empty())
+    {
+        return;
+    }
+
+    _stopping = false;
+
+    for (uint32 i = 0; i < threads; ++i)
+    {
+        _workers.push_back(std::thread(&AHBWorkerPool::Work, this));
+    }
+}
+
+void AHBWorkerPool::Stop()
+{
+    if (_workers.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+
+    _wakeup.notify_all();
+
+    for (std::thread& worker: _workers)
+    {
+        worker.join();
+    }
+
+    _workers.clear();
+}
+
+bool AHBWorkerPool::IsRunning()
+{
+    return !_workers.empty();
+}
+
+void AHBWorkerPool::Run(std::vector<std::function<void()>> const& tasks)
+{
+    //
+    // Without workers, the tasks are just run here
+    //
+
+    if (_workers.empty())
+    {
+        for (std::function<void()> const& task: tasks)
+        {
+            task();
+        }
+
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(_lock);
+
+    _tasks.insert(_tasks.end(), tasks.begin(), tasks.end());
+    _pending += tasks.size();
+
+    _wakeup.notify_all();
+
+    //
+    // Help with the batch, then wait for the tasks taken by the workers
+    //
+
+    while (RunNext(guard))
+    {
+    }
+
+    _finished.wait(guard, [this] { return _pending == 0; });
+}
+
+void AHBWorkerPool::Work()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+
+    while (true)
+    {
+        _wakeup.wait(guard, [this] { return _stopping || !_tasks.empty(); });
+
+        if (_stopping)
+        {
+            break;
+        }
+
+        RunNext(guard);
+    }
+}
+
+bool AHBWorkerPool::RunNext(std::unique_lock<std::mutex>& guard)
+{
+    if (_tasks.empty())
+    {
+        return false;
+    }
+
+    std::function<void()> task = _tasks.front();
+    _tasks.pop_front();
+
+    //
+    // The task runs without holding the lock
+    //
+
+    guard.unlock();
+    task();
+    guard.lock();
+
+    if (--_pending == 0)
+    {
+        _finished.notify_all();
+    }
+
+    return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_POOL_H
+#define AUCTION_HOUSE_BOT_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// A few threads running a batch of independent tasks on behalf of the world thread,
+// which takes part in the work and returns when the whole batch is completed.
+// =============================================================================
+
+class AHBWorkerPool
+{
+private:
+    std::vector<std::thread>           _workers;
+    std::mutex                         _lock;
+    std::condition_variable            _wakeup;   // Tasks were queued or the pool is stopping
+    std::condition_variable            _finished; // The last task of the batch completed
+    std::deque<std::function<void()>>  _tasks;
+    uint32                             _pending;  // Tasks of the batch not completed yet
+    bool                               _stopping;
+
+    void Work();
+    bool RunNext(std::unique_lock<std::mutex>& guard);
+
+public:
+    AHBWorkerPool();
+    ~AHBWorkerPool();
+
+    void Start    (uint32 threads);
+    void Stop     ();
+    bool IsRunning();
+
+    void Run      (std::vector<std::function<void()>> const& tasks);
+};
+
+extern AHBWorkerPool gPool;
+
+#endif // AUCTION_HOUSE_BOT_POOL_H
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include "Random.h"
+
+#include "AuctionHouseBotSampler.h"
+
+AHBSampler::AHBSampler()
+{
+}
+
+AHBSampler::~AHBSampler()
+{
+}
+
+void AHBSampler::Build(std::vector<uint32> const& weights)
+{
+    _values.clear();
+    _aliases.clear();
+    _probability.clear();
+
+    //
+    // Only the values with a weight can be selected
+    //
+
+    uint64 total = 0;
+
+    for (uint32 value = 0; value < weights.size(); ++value)
+    {
+        if (weights[value] > 0)
+        {
+            _values.push_back(value);
+            total += weights[value];
+        }
+    }
+
+    if (_values.empty())
+    {
+        return;
+    }
+
+    //
+    // Scale the weights so that their average is one, then split the columns in the ones
+    // below and above the average
+    //
+
+    uint32 n = _values.size();
+
+    _aliases.resize(n);
+    _probability.resize(n);
+
+    std::vector<double> scaled(n);
+    std::vector<uint32> small;
+    std::vector<uint32> large;
+
+    for (uint32 i = 0; i < n; ++i)
+    {
+        scaled[i]   = double(weights[_values[i]]) * n / double(total);
+        _aliases[i] = _values[i];
+
+        if (scaled[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    //
+    // Fill every small column with the excess of a large one
+    //
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32 s = small.back();
+        uint32 l = large.back();
+
+        small.pop_back();
+
+        _probability[s] = scaled[s];
+        _aliases[s]     = _values[l];
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    //
+    // What is left is full, but for rounding errors
+    //
+
+    for (uint32 i: large)
+    {
+        _probability[i] = 1.0;
+    }
+
+    for (uint32 i: small)
+    {
+        _probability[i] = 1.0;
+    }
+}
+
+bool AHBSampler::Empty()
+{
+    return _values.empty();
+}
+
+uint32 AHBSampler::Sample()
+{
+    uint32 column = urand(0, _values.size() - 1);
+
+    if (rand_norm() < _probability[column])
+    {
+        return _values[column];
+    }
+
+    return _aliases[column];
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_SAMPLER_H
+#define AUCTION_HOUSE_BOT_SAMPLER_H
+
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// Weighted random selection over a small set of values (Walker's alias method).
+// Building costs O(n), every sample afterwards costs O(1).
+// =============================================================================
+
+class AHBSampler
+{
+private:
+    std::vector<uint32> _values;      // Values with a weight greater than zero
+    std::vector<uint32> _aliases;     // Value returned when the probability test fails
+    std::vector<double> _probability; // Probability to keep the value of the column
+
+public:
+    AHBSampler();
+    ~AHBSampler();
+
+    void   Build(std::vector<uint32> const& weights);
+    bool   Empty();
+    uint32 Sample();
+};
+
+#endif // AUCTION_HOUSE_BOT_SAMPLER_H
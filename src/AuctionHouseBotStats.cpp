@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "StringFormat.h"
+
+#include "AuctionHouseBotStats.h"
+
+AHBHistogram::AHBHistogram()
+{
+    Reset();
+}
+
+void AHBHistogram::Record(uint64 us)
+{
+    uint32 bucket = 0;
+
+    while (bucket < AHB_HISTOGRAM_BUCKETS - 1 && (uint64(1) << bucket) <= us)
+    {
+        bucket++;
+    }
+
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _total.fetch_add(us, std::memory_order_relaxed);
+
+    uint64 max = _max.load(std::memory_order_relaxed);
+
+    while (us > max && !_max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+    {
+    }
+}
+
+void AHBHistogram::Record(std::chrono::steady_clock::time_point start)
+{
+    Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void AHBHistogram::Reset()
+{
+    for (uint32 bucket = 0; bucket < AHB_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        _buckets[bucket].store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _total.store(0, std::memory_order_relaxed);
+    _max.store  (0, std::memory_order_relaxed);
+}
+
+uint64 AHBHistogram::GetCount()
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+uint64 AHBHistogram::GetTotal()
+{
+    return _total.load(std::memory_order_relaxed);
+}
+
+uint64 AHBHistogram::GetMax()
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+uint64 AHBHistogram::GetBucket(uint32 bucket)
+{
+    return _buckets[bucket].load(std::memory_order_relaxed);
+}
+
+uint64 AHBHistogram::Percentile(uint32 percent)
+{
+    uint64 count = GetCount();
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    //
+    // Walk the buckets until the requested share of the samples is reached
+    //
+
+    uint64 rank = (count * percent + 99) / 100;
+    uint64 seen = 0;
+
+    for (uint32 bucket = 0; bucket < AHB_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        seen += _buckets[bucket].load(std::memory_order_relaxed);
+
+        if (seen >= rank)
+        {
+            return std::min(uint64(1) << bucket, GetMax());
+        }
+    }
+
+    return GetMax();
+}
+
+AHBStopwatch::AHBStopwatch(AHBHistogram& histogram) : _histogram(histogram)
+{
+    _start = std::chrono::steady_clock::now();
+}
+
+AHBStopwatch::~AHBStopwatch()
+{
+    _histogram.Record(_start);
+}
+
+AHBStats::AHBStats()
+{
+    Reset();
+}
+
+uint32 AHBStats::getHouseIndex(uint32 ahid)
+{
+    switch (ahid)
+    {
+    case 2:
+        return 0;
+    case 6:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+AHBHistogram& AHBStats::GetUpdate()
+{
+    return _update;
+}
+
+AHBHistogram& AHBStats::Get(uint32 ahid, AHBPhase phase)
+{
+    return _houses[getHouseIndex(ahid)][phase];
+}
+
+void AHBStats::Add(uint32 ahid, AHBCounter counter, uint64 value)
+{
+    _counters[getHouseIndex(ahid)][counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64 AHBStats::Get(uint32 ahid, AHBCounter counter)
+{
+    return _counters[getHouseIndex(ahid)][counter].load(std::memory_order_relaxed);
+}
+
+void AHBStats::Reset()
+{
+    _update.Reset();
+
+    for (uint32 house = 0; house < AHB_STATS_HOUSES; ++house)
+    {
+        for (uint32 phase = 0; phase < AHB_PHASES; ++phase)
+        {
+            _houses[house][phase].Reset();
+        }
+
+        for (uint32 counter = 0; counter < AHB_COUNTERS; ++counter)
+        {
+            _counters[house][counter].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AHBStats::Report(uint32 botId, std::vector<std::string>& lines)
+{
+    static char const* houseNames[AHB_STATS_HOUSES] = { "alliance", "horde", "neutral" };
+    static char const* phaseNames[AHB_PHASES]       = { "update", "sell", "buy", "plan", "create", "flush" };
+
+    //
+    // Only the phases which ran at least once are reported
+    //
+
+    if (_update.GetCount() > 0)
+    {
+        lines.push_back(Acore::StringFormat("bot {} {}: calls={} p50={}us p95={}us p99={}us max={}us total={}us", botId, phaseNames[AHB_PHASE_UPDATE],
+            _update.GetCount(), _update.Percentile(50), _update.Percentile(95), _update.Percentile(99), _update.GetMax(), _update.GetTotal()));
+    }
+
+    for (uint32 house = 0; house < AHB_STATS_HOUSES; ++house)
+    {
+        for (uint32 phase = 0; phase < AHB_PHASES; ++phase)
+        {
+            AHBHistogram& histogram = _houses[house][phase];
+
+            if (histogram.GetCount() == 0)
+            {
+                continue;
+            }
+
+            lines.push_back(Acore::StringFormat("bot {} {} {}: calls={} p50={}us p95={}us p99={}us max={}us total={}us", botId, houseNames[house], phaseNames[phase],
+                histogram.GetCount(), histogram.Percentile(50), histogram.Percentile(95), histogram.Percentile(99), histogram.GetMax(), histogram.GetTotal()));
+        }
+
+        std::atomic<uint64>* counters = _counters[house];
+
+        if (counters[AHB_COUNTER_SOLD] + counters[AHB_COUNTER_BIDS] + counters[AHB_COUNTER_BUYOUTS] + counters[AHB_COUNTER_ERROR] > 0)
+        {
+            lines.push_back(Acore::StringFormat("bot {} {} outcomes: sold={} binEmpty={} noNeed={} tooMany={} loopBrk={} err={} bids={} buyouts={}", botId, houseNames[house],
+                counters[AHB_COUNTER_SOLD].load(), counters[AHB_COUNTER_BIN_EMPTY].load(), counters[AHB_COUNTER_NO_NEED].load(), counters[AHB_COUNTER_TOO_MANY].load(),
+                counters[AHB_COUNTER_LOOP_BREAK].load(), counters[AHB_COUNTER_ERROR].load(), counters[AHB_COUNTER_BIDS].load(), counters[AHB_COUNTER_BUYOUTS].load()));
+        }
+    }
+}
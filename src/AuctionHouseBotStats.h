@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_STATS_H
+#define AUCTION_HOUSE_BOT_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+
+//
+// Timed phases of the bot
+//
+
+enum AHBPhase : uint32
+{
+    AHB_PHASE_UPDATE,     // Whole update of a bot, all the auction houses
+    AHB_PHASE_SELL,       // Seller cycle
+    AHB_PHASE_BUY,        // Buyer interval
+    AHB_PHASE_PLAN,       // Choice of the listings and of the auctions to bid on
+    AHB_PHASE_CREATE,     // Creation of an item and its auction
+    AHB_PHASE_FLUSH,      // Commit of a database transaction
+
+    AHB_PHASES
+};
+
+//
+// Outcomes counted by the bot
+//
+
+enum AHBCounter : uint32
+{
+    AHB_COUNTER_SOLD,       // Auctions created by the seller
+    AHB_COUNTER_BIN_EMPTY,  // Seller cycles stopped because no item could be selected
+    AHB_COUNTER_NO_NEED,    // Listings discarded because their category was full
+    AHB_COUNTER_TOO_MANY,   // Listings discarded because of the duplicates
+    AHB_COUNTER_LOOP_BREAK, // Listings given up after too many discarded ones
+    AHB_COUNTER_ERROR,      // Items which could not be created
+    AHB_COUNTER_BIDS,       // Bids placed by the buyer
+    AHB_COUNTER_BUYOUTS,    // Auctions bought out by the buyer
+
+    AHB_COUNTERS
+};
+
+#define AHB_STATS_HOUSES      3  // Alliance, Horde and Neutral
+#define AHB_HISTOGRAM_BUCKETS 32 // Powers of two of microseconds, up to more than half an hour
+
+// =============================================================================
+// Distribution of durations in buckets of growing size (the n-th bucket holds the
+// durations below 2^n microseconds). Recording is lock free, percentiles are
+// reported as the upper bound of their bucket.
+// =============================================================================
+
+class AHBHistogram
+{
+private:
+    std::atomic<uint64> _buckets[AHB_HISTOGRAM_BUCKETS];
+    std::atomic<uint64> _count;
+    std::atomic<uint64> _total;
+    std::atomic<uint64> _max;
+
+public:
+    AHBHistogram();
+
+    void   Record    (uint64 us);
+    void   Record    (std::chrono::steady_clock::time_point start);
+    void   Reset     ();
+
+    uint64 GetCount  ();
+    uint64 GetTotal  ();
+    uint64 GetMax    ();
+    uint64 GetBucket (uint32 bucket);
+    uint64 Percentile(uint32 percent);
+};
+
+// =============================================================================
+// Measures the time spent in a scope
+// =============================================================================
+
+class AHBStopwatch
+{
+private:
+    AHBHistogram&                         _histogram;
+    std::chrono::steady_clock::time_point _start;
+
+public:
+    AHBStopwatch(AHBHistogram& histogram);
+    ~AHBStopwatch();
+};
+
+// =============================================================================
+// Timings of a bot, by auction house and phase
+// =============================================================================
+
+class AHBStats
+{
+private:
+    AHBHistogram        _update;
+    AHBHistogram        _houses  [AHB_STATS_HOUSES][AHB_PHASES];
+    std::atomic<uint64> _counters[AHB_STATS_HOUSES][AHB_COUNTERS];
+
+    static uint32 getHouseIndex(uint32 ahid);
+
+public:
+    AHBStats();
+
+    AHBHistogram& GetUpdate();
+    AHBHistogram& Get      (uint32 ahid, AHBPhase phase);
+
+    void          Add      (uint32 ahid, AHBCounter counter, uint64 value);
+    uint64        Get      (uint32 ahid, AHBCounter counter);
+
+    void          Reset    ();
+    void          Report   (uint32 botId, std::vector<std::string>& lines);
+};
+
+#endif // AUCTION_HOUSE_BOT_STATS_H
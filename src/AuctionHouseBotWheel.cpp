@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include "AuctionHouseBotWheel.h"
+
+AHBExpiryWheel::AHBExpiryWheel()
+{
+    _slots.resize(AHB_WHEEL_SLOTS);
+    _cursor = 0;
+}
+
+AHBExpiryWheel::~AHBExpiryWheel()
+{
+}
+
+time_t AHBExpiryWheel::getMinute(time_t expire)
+{
+    return expire / AHB_WHEEL_SLOT_SECONDS;
+}
+
+std::vector<uint32>& AHBExpiryWheel::getSlot(time_t minute)
+{
+    return _slots[minute % AHB_WHEEL_SLOTS];
+}
+
+void AHBExpiryWheel::Add(uint32 auctionId, time_t expire)
+{
+    if (_expires.find(auctionId) != _expires.end())
+    {
+        return;
+    }
+
+    time_t minute = getMinute(expire);
+
+    if (_expires.empty() || minute < _cursor)
+    {
+        _cursor = minute;
+    }
+
+    _expires[auctionId] = expire;
+    getSlot(minute).push_back(auctionId);
+}
+
+void AHBExpiryWheel::Remove(uint32 auctionId)
+{
+    std::unordered_map<uint32, time_t>::iterator it = _expires.find(auctionId);
+
+    if (it == _expires.end())
+    {
+        return;
+    }
+
+    std::vector<uint32>& slot = getSlot(getMinute(it->second));
+
+    for (uint32 i = 0; i < slot.size(); ++i)
+    {
+        if (slot[i] == auctionId)
+        {
+            slot[i] = slot.back();
+            slot.pop_back();
+            break;
+        }
+    }
+
+    _expires.erase(it);
+}
+
+void AHBExpiryWheel::Clear()
+{
+    for (std::vector<uint32>& slot: _slots)
+    {
+        slot.clear();
+    }
+
+    _expires.clear();
+    _cursor = 0;
+}
+
+bool AHBExpiryWheel::Empty()
+{
+    return _expires.empty();
+}
+
+void AHBExpiryWheel::advance(time_t until)
+{
+    //
+    // Move the cursor past the minutes left without auctions. A slot also holds the auctions
+    // expiring a whole turn later, which are told apart by their expiration time.
+    //
+
+    time_t last = getMinute(until);
+
+    while (_cursor < last)
+    {
+        bool found = false;
+
+        for (uint32 auctionId: getSlot(_cursor))
+        {
+            if (getMinute(_expires[auctionId]) == _cursor)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (found)
+        {
+            break;
+        }
+
+        _cursor++;
+    }
+}
+
+uint32 AHBExpiryWheel::Count(time_t until)
+{
+    if (_expires.empty())
+    {
+        return 0;
+    }
+
+    advance(until);
+
+    //
+    // Same walk as Collect(), without gathering the auctions
+    //
+
+    uint32 count = 0;
+    time_t last  = getMinute(until);
+
+    for (time_t minute = _cursor; minute <= last && minute < _cursor + AHB_WHEEL_SLOTS; ++minute)
+    {
+        for (uint32 auctionId: getSlot(minute))
+        {
+            time_t expire = _expires[auctionId];
+
+            if (getMinute(expire) == minute && expire <= until)
+            {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+void AHBExpiryWheel::Collect(time_t until, std::vector<uint32>& auctionIds)
+{
+    auctionIds.clear();
+
+    if (_expires.empty())
+    {
+        return;
+    }
+
+    advance(until);
+
+    //
+    // Gather the auctions expiring until the given time, the soonest first
+    //
+
+    time_t last = getMinute(until);
+
+    for (time_t minute = _cursor; minute <= last && minute < _cursor + AHB_WHEEL_SLOTS; ++minute)
+    {
+        for (uint32 auctionId: getSlot(minute))
+        {
+            time_t expire = _expires[auctionId];
+
+            if (getMinute(expire) == minute && expire <= until)
+            {
+                auctionIds.push_back(auctionId);
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_WHEEL_H
+#define AUCTION_HOUSE_BOT_WHEEL_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common.h"
+
+#define AHB_WHEEL_SLOTS        8192 // Minutes covered by a turn of the wheel, longer than any auction
+#define AHB_WHEEL_SLOT_SECONDS   60
+
+// =============================================================================
+// Auctions ordered by expiration time, in slots of one minute (hashed timing wheel).
+// Adding and removing cost O(1), looking for what expires next only visits the
+// slots between the oldest auction and the requested time.
+// =============================================================================
+
+class AHBExpiryWheel
+{
+private:
+    std::vector<std::vector<uint32>>   _slots;   // Auctions ids, by minute of expiration modulo the size of the wheel
+    std::unordered_map<uint32, time_t> _expires; // Expiration time of every auction in the wheel
+    time_t                             _cursor;  // No auction expires before this minute
+
+    static time_t getMinute(time_t expire);
+
+    std::vector<uint32>& getSlot(time_t minute);
+    void                 advance(time_t until);
+
+public:
+    AHBExpiryWheel();
+    ~AHBExpiryWheel();
+
+    void   Add    (uint32 auctionId, time_t expire);
+    void   Remove (uint32 auctionId);
+    void   Clear  ();
+    bool   Empty  ();
+
+    uint32 Count  (time_t until);
+    void   Collect(time_t until, std::vector<uint32>& auctionIds);
+};
+
+#endif // AUCTION_HOUSE_BOT_WHEEL_H
@@ -2,11 +2,20 @@
  * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
  */
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "Config.h"
 #include "Log.h"
 
 #include "AuctionHouseBot.h"
+#include "AuctionHouseBotBinCache.h"
 #include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotItemSources.h"
+#include "AuctionHouseBotMetrics.h"
+#include "AuctionHouseBotPlanner.h"
+#include "AuctionHouseBotPool.h"
 #include "AuctionHouseBotWorldScript.h"
 
 // =============================================================================
@@ -107,18 +116,23 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
         DeleteBots();
 
         //
-        // Reload the configuration for the auction houses
+        // The planned listings refer to the bins, which are going to be filled again
+        //
+
+        gPlanner.Flush();
+
+        //
+        // Reload the configuration for the auction houses; their settings and the sources of the items are read from the database at once
         //
 
-        gAllianceConfig->Initialize(gBotsId);
-        gHordeConfig->Initialize   (gBotsId);
-        gNeutralConfig->Initialize (gBotsId);
+        LoadConfigs();
 
         //
         // Start again the bots
         //
 
         PopulateBots();
+        StartWorkers();
     }
 }
 
@@ -127,18 +141,112 @@ void AHBot_WorldScript::OnStartup()
     LOG_INFO("server.loading", "Initialize AuctionHouseBot...");
 
     //
-    // Initialize the configuration (done only once at startup)
+    // Initialize the configuration (done only once at startup); the settings of the auction houses and the sources of the items are read from the database at once
     //
 
-    gAllianceConfig->Initialize(gBotsId);
-    gHordeConfig->Initialize   (gBotsId);
-    gNeutralConfig->Initialize (gBotsId);
+    LoadConfigs();
 
     //
     // Starts the bots
     //
 
     PopulateBots();
+    StartWorkers();
+}
+
+void AHBot_WorldScript::OnShutdown()
+{
+    gPlanner.Stop();
+    gPool.Stop();
+    gMetrics.Stop();
+
+    //
+    // Release the sessions and the characters kept by the bots
+    //
+
+    DeleteBots();
+}
+
+void AHBot_WorldScript::LoadConfigs()
+{
+    bool debug = sConfigMgr->GetOption<bool>("AuctionHouseBot.DEBUG_CONFIG", false);
+
+    AHBHousesSettings houses;
+    AHBConfig::LoadHousesSettings(houses);
+
+    //
+    // The bins cache, if any, is used only if the item templates and the tables of the sources did not change since it was written
+    //
+
+    AHBBinCache cache;
+    std::string path = sConfigMgr->GetOption<std::string>("AuctionHouseBot.BinsCacheFile", "");
+
+    if (!path.empty())
+    {
+        uint64 fingerprint = AHBItemSources::GetFingerprint();
+
+        if (fingerprint == 0)
+        {
+            LOG_ERROR("module", "AHBot: Cannot checksum the tables of the items, the bins cache is not used");
+        }
+        else if (cache.Open(path, fingerprint))
+        {
+            if (debug)
+            {
+                LOG_INFO("module", "AHBot: Using the bins cache {}", path);
+            }
+        }
+    }
+
+    std::shared_ptr<AHBItemSources> sources = std::make_shared<AHBItemSources>();
+    sources->Load(debug, cache.IsEnabled() ? &cache : NULL);
+
+    gAllianceConfig->Initialize(gBotsId, houses, sources);
+    gHordeConfig->Initialize   (gBotsId, houses, sources);
+    gNeutralConfig->Initialize (gBotsId, houses, sources);
+
+    //
+    // The bins of the three auction houses are built at once: each house filters the item templates in slices,
+    // and all the slices are shared by the world thread and the loading threads, if any
+    //
+
+    uint32 threads = sConfigMgr->GetOption<uint32>("AuctionHouseBot.LoadingThreads", 0);
+
+    std::vector<std::function<void()>> tasks;
+
+    AHBBinCache const* cached = cache.IsEnabled() ? &cache : NULL;
+
+    gAllianceConfig->PrepareBins(threads + 1, tasks, cached);
+    gHordeConfig->PrepareBins   (threads + 1, tasks, cached);
+    gNeutralConfig->PrepareBins (threads + 1, tasks, cached);
+
+    AHBWorkerPool loader;
+
+    loader.Start(threads);
+    loader.Run(tasks);
+    loader.Stop();
+
+    //
+    // The slices are merged and the bins reported one house at a time
+    //
+
+    gAllianceConfig->InitializeBins();
+    gHordeConfig->InitializeBins();
+    gNeutralConfig->InitializeBins();
+
+    //
+    // Write back the cache if anything had to be loaded or filtered
+    //
+
+    if (cache.IsEnabled())
+    {
+        for (AHBConfig* config: { gAllianceConfig, gHordeConfig, gNeutralConfig })
+        {
+            cache.SetBins(config->GetAHID(), config->GetBinsHash(), config);
+        }
+
+        cache.Save();
+    }
 }
 
 void AHBot_WorldScript::DeleteBots()
@@ -175,6 +283,8 @@ void AHBot_WorldScript::PopulateBots()
 {
     uint32 account = sConfigMgr->GetOption<uint32>("AuctionHouseBot.Account", 0);
 
+    gBotsPerTick   = sConfigMgr->GetOption<uint32>("AuctionHouseBot.BotsPerTick", 0);
+
     // 
     // Insert the bot in the list used for auction house iterations
     // 
@@ -189,3 +299,39 @@ void AHBot_WorldScript::PopulateBots()
         gBots.insert(bot);
     }
 }
+
+void AHBot_WorldScript::StartWorkers()
+{
+    //
+    // Listings are planned on the world thread, unless the worker is enabled
+    //
+
+    if (sConfigMgr->GetOption<bool>("AuctionHouseBot.AsyncPlanner", false))
+    {
+        gPlanner.Start();
+    }
+    else
+    {
+        gPlanner.Stop();
+    }
+
+    //
+    // The auction houses are processed one after the other, unless the pool is enabled.
+    // The world thread works on one of them, so two workers are enough for the three houses.
+    //
+
+    if (sConfigMgr->GetOption<bool>("AuctionHouseBot.ParallelHouses", false))
+    {
+        gPool.Start(2);
+    }
+    else
+    {
+        gPool.Stop();
+    }
+
+    //
+    // The metrics are exported only if a file is given
+    //
+
+    gMetrics.Start(sConfigMgr->GetOption<std::string>("AuctionHouseBot.MetricsFile", ""), sConfigMgr->GetOption<uint32>("AuctionHouseBot.MetricsInterval", 15));
+}
@@ -14,14 +14,17 @@
 class AHBot_WorldScript : public WorldScript
 {
 private:
+    void LoadConfigs();
     void DeleteBots();
     void PopulateBots();
+    void StartWorkers();
 
 public:
     AHBot_WorldScript();
 
     void OnBeforeConfigLoad(bool reload) override;
     void OnStartup() override;
+    void OnShutdown() override;
 };
 
 #endif /* AUCTION_HOUSE_BOT_WORLD_SCRIPT_H */
@@ -166,6 +166,39 @@ public:
 
             return true;
         }
+        else if (strncmp(opt, "stats", l) == 0)
+        {
+            char* param1 = strtok(NULL, " ");
+
+            //
+            // Clear the timings collected so far
+            //
+
+            if (param1 && strncmp(param1, "reset", strlen(param1)) == 0)
+            {
+                for (AuctionHouseBot* bot: gBots)
+                {
+                    bot->ResetStats();
+                }
+
+                handler->PSendSysMessage("AHBot statistics cleared");
+                return true;
+            }
+
+            std::vector<std::string> lines;
+
+            for (AuctionHouseBot* bot: gBots)
+            {
+                bot->ReportStats(lines);
+            }
+
+            for (std::string const& line: lines)
+            {
+                handler->SendSysMessage(line);
+            }
+
+            return true;
+        }
 
         //
         // Retrieve the auction house type
@@ -209,6 +242,7 @@ public:
             handler->PSendSysMessage("buyer - enable/disable buyer");
             handler->PSendSysMessage("seller - enable/disabler seller");
             handler->PSendSysMessage("usemarketprice - enable/disabler selling at market price");
+            handler->PSendSysMessage("stats - show the timings of the bots, or clear them with stats reset");
             handler->PSendSysMessage("ahexpire - remove all bot auctions");
             handler->PSendSysMessage("minitems - set min auctions");
             handler->PSendSysMessage("maxitems - set max auctions");
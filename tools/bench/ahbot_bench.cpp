@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+//
+// Offline market simulator: runs the seller and the buyer of the module on synthetic auction houses,
+// held in memory by the stand-ins of the core, and reports how fast they go.
+//
+// Usage: ahbot_bench [--sizes=1000,10000,...] [--cycles=N] [--templates=N] [--houses=1|3] [--bots=N]
+//                    [--bot-share=PERCENT] [--seed=N] [--log] [Option=Value ...]
+//
+// Every Option=Value is given to the module as AuctionHouseBot.Option, e.g. ItemsPerCycle=500 or AsyncPlanner=1.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "StandIns.h"
+
+#include "AuctionHouseBot.h"
+#include "AuctionHouseBotAuctionHouseScript.h"
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotConfig.h"
+#include "AuctionHouseBotWorldScript.h"
+
+#define BENCH_PLAYERS_BASE 1000000 // Players owning the synthetic auctions have guids from here
+#define BENCH_PLAYERS      5000
+
+struct BenchOptions
+{
+    std::vector<uint32> Sizes     = { 1000, 10000, 100000, 1000000 }; // Auctions in every active auction house
+    uint32              Cycles    = 20;                               // Updates of the bots for each size
+    uint32              Templates = 20000;                            // Item templates to choose from
+    uint32              Houses    = 1;                                // Neutral only, or all three
+    uint32              Bots      = 1;
+    uint32              BotShare  = 50;                               // Percentage of the auctions owned by the bots
+    uint32              Seed      = 0;
+};
+
+struct BenchResult
+{
+    uint32 Size;
+    double LoadMs;
+    double CycleP50Ms;
+    double CycleP95Ms;
+    double CycleMaxMs;
+    uint64 Listings;
+    double ListingsPerSec;
+    uint64 Bids;
+    double BidsPerSec;
+    uint64 Commits;
+};
+
+static uint32 const gHouses[] = { AUCTIONHOUSE_NEUTRAL, AUCTIONHOUSE_ALLIANCE, AUCTIONHOUSE_HORDE };
+
+// =============================================================================
+// Parse the command line
+// =============================================================================
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg   = argv[i];
+        size_t      equal = arg.find('=');
+        std::string key   = arg.substr(0, equal);
+        std::string value = equal == std::string::npos ? "" : arg.substr(equal + 1);
+
+        if (key == "--sizes")
+        {
+            options.Sizes.clear();
+
+            size_t start = 0;
+
+            while (start <= value.size())
+            {
+                size_t comma = value.find(',', start);
+
+                options.Sizes.push_back(uint32(std::strtoul(value.substr(start, comma - start).c_str(), nullptr, 10)));
+
+                if (comma == std::string::npos)
+                {
+                    break;
+                }
+
+                start = comma + 1;
+            }
+        }
+        else if (key == "--cycles")
+        {
+            options.Cycles = std::strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "--templates")
+        {
+            options.Templates = std::max<uint32>(1, std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (key == "--houses")
+        {
+            options.Houses = std::strtoul(value.c_str(), nullptr, 10) >= 3 ? 3 : 1;
+        }
+        else if (key == "--bots")
+        {
+            options.Bots = std::max<uint32>(1, std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (key == "--bot-share")
+        {
+            options.BotShare = std::min<uint32>(100, std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (key == "--seed")
+        {
+            options.Seed = std::strtoul(value.c_str(), nullptr, 10);
+        }
+        else if (key == "--log")
+        {
+            gBenchLog = true;
+        }
+        else if (equal != std::string::npos && key.compare(0, 2, "--") != 0)
+        {
+            sConfigMgr->Values["AuctionHouseBot." + key] = value;
+        }
+        else
+        {
+            fmt::print(stderr, "Unknown argument: {}\n", arg);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// =============================================================================
+// Synthetic item templates, all of them lootable
+// =============================================================================
+
+static void createTemplates(BenchOptions const& options)
+{
+    sObjectMgr->Templates.clear();
+
+    std::vector<BenchDatabase::Row>& loot = WorldDatabase.Tables["creature_loot_template"];
+
+    loot.clear();
+
+    for (uint32 id = 1; id <= options.Templates; ++id)
+    {
+        ItemTemplate proto;
+
+        proto.ItemId        = id;
+        proto.Class         = (id % 4 == 0) ? ITEM_CLASS_TRADE_GOODS : ((id % 2) ? ITEM_CLASS_ARMOR : ITEM_CLASS_WEAPON);
+        proto.Quality       = std::min<uint32>(urand(0, 100) / 20, ITEM_QUALITY_LEGENDARY);
+        proto.ItemLevel     = urand(1, 80);
+        proto.RequiredLevel = proto.ItemLevel;
+        proto.SellPrice     = urand(10, 100) * (proto.Quality + 1) * proto.ItemLevel;
+        proto.BuyPrice      = proto.SellPrice * 4;
+        proto.Stackable     = proto.Class == ITEM_CLASS_TRADE_GOODS ? 20 : 1;
+        proto.Bonding       = proto.Class == ITEM_CLASS_TRADE_GOODS ? NO_BIND : BIND_WHEN_EQUIPPED;
+
+        sObjectMgr->Templates[id] = proto;
+
+        loot.push_back({ { "item", std::to_string(id) } });
+    }
+
+    //
+    // The seller stays disabled when no item is disabled, so one is, outside of the templates
+    //
+
+    WorldDatabase.Tables["mod_auctionhousebot_disabled_items"] = { { { "item", std::to_string(options.Templates + 1) } } };
+}
+
+// =============================================================================
+// Settings of the auction houses, as the module reads them from the database
+// =============================================================================
+
+static void createHouseSettings(BenchOptions const& options, uint32 size)
+{
+    static char const* const qualities[] = { "grey", "white", "green", "blue", "purple", "orange", "yellow" };
+
+    std::vector<BenchDatabase::Row>& houses = WorldDatabase.Tables["mod_auctionhousebot"];
+
+    houses.clear();
+
+    //
+    // The seller has always something to list: its target is above what the bots own at the start
+    // by the listings of all the cycles
+    //
+
+    uint32 botAuctions = uint64(size) * options.BotShare / 100;
+    uint32 perCycle    = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle", 200);
+    uint32 target      = botAuctions / options.Bots + perCycle * (options.Cycles + 1);
+
+    for (uint32 ahid: gHouses)
+    {
+        bool active = ahid == AUCTIONHOUSE_NEUTRAL || options.Houses == 3;
+
+        BenchDatabase::Row row;
+
+        row["auctionhouse"]         = std::to_string(ahid);
+        row["minitems"]             = std::to_string(active ? target : 0);
+        row["maxitems"]             = std::to_string(active ? target : 0);
+        row["buyerbiddinginterval"] = "0";
+        row["buyerbidsperinterval"] = active ? "100" : "0";
+
+        for (uint32 quality = 0; quality <= AHB_MAX_QUALITY; ++quality)
+        {
+            std::string name = qualities[quality];
+
+            row["percent" + name + "tradegoods"] = quality == 0 ? "9" : "7";
+            row["percent" + name + "items"]      = "7";
+            row["minprice" + name]               = "100";
+            row["maxprice" + name]               = "150";
+            row["minbidprice" + name]            = "70";
+            row["maxbidprice" + name]            = "100";
+            row["maxstack" + name]               = "0";
+            row["buyerprice" + name]             = "2";
+        }
+
+        houses.push_back(row);
+    }
+
+    CharacterDatabase.Tables["characters"].clear();
+
+    for (uint32 bot = 1; bot <= options.Bots; ++bot)
+    {
+        CharacterDatabase.Tables["characters"].push_back({ { "guid", std::to_string(bot) }, { "account", "1" } });
+    }
+}
+
+// =============================================================================
+// Fill and empty the auction houses
+// =============================================================================
+
+static void populateHouses(BenchOptions const& options, uint32 size)
+{
+    time_t now = time(nullptr);
+
+    for (uint32 ahid: gHouses)
+    {
+        if (ahid != AUCTIONHOUSE_NEUTRAL && options.Houses != 3)
+        {
+            continue;
+        }
+
+        AuctionHouseEntry const* ahEntry      = sAuctionHouseStore.LookupEntry(ahid);
+        AuctionHouseObject*      auctionHouse = sAuctionMgr->GetAuctionsMap(ahEntry->faction);
+
+        for (uint32 cnt = 0; cnt < size; ++cnt)
+        {
+            uint32              entry = urand(1, options.Templates);
+            ItemTemplate const* proto = sObjectMgr->GetItemTemplate(entry);
+            Item*               item  = Item::CreateItem(entry, urand(1, proto->GetMaxStackSize()));
+            bool                bot   = urand(1, 100) <= options.BotShare;
+
+            sAuctionMgr->AddAItem(item);
+
+            AuctionEntry* auction = new AuctionEntry();
+
+            auction->Id                = sObjectMgr->GenerateAuctionID();
+            auction->houseId           = ahid;
+            auction->item_guid         = item->GetGUID();
+            auction->item_template     = entry;
+            auction->itemCount         = item->GetCount();
+            auction->owner             = ObjectGuid::Create<HighGuid::Player>(bot ? urand(1, options.Bots) : BENCH_PLAYERS_BASE + urand(1, BENCH_PLAYERS));
+            auction->startbid          = std::max<uint32>(1, uint64(proto->BuyPrice) * item->GetCount() * urand(50, 250) / 100);
+            auction->buyout            = urand(0, 3) ? auction->startbid * urand(110, 200) / 100 : 0;
+            auction->expire_time       = now + urand(1, 48) * HOUR;
+            auction->deposit           = 0;
+            auction->auctionHouseEntry = ahEntry;
+
+            auctionHouse->AddAuction(auction);
+        }
+    }
+}
+
+static void clearHouses()
+{
+    for (uint32 ahid: gHouses)
+    {
+        AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(sAuctionHouseStore.LookupEntry(ahid)->faction);
+
+        while (auctionHouse->Getcount() > 0)
+        {
+            AuctionEntry* auction = auctionHouse->GetAuctionsBegin()->second;
+
+            sAuctionMgr->RemoveAItem(auction->item_guid, true);
+            auctionHouse->RemoveAuction(auction);
+        }
+    }
+}
+
+// =============================================================================
+// Run the bots on an auction house of the given size
+// =============================================================================
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static BenchResult runScenario(BenchOptions const& options, AHBot_WorldScript& worldScript, uint32 size, bool first)
+{
+    BenchResult result = BenchResult();
+
+    result.Size = size;
+
+    clearHouses();
+    createHouseSettings(options, size);
+
+    //
+    // Load the settings and start the bots, as the world does at startup and on reload
+    //
+
+    if (first)
+    {
+        worldScript.OnBeforeConfigLoad(false);
+        worldScript.OnStartup();
+    }
+    else
+    {
+        worldScript.OnBeforeConfigLoad(true);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    populateHouses(options, size);
+
+    result.LoadMs = elapsedMs(start);
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        bot->ResetStats();
+    }
+
+    uint64 commits = CharacterDatabase.Commits;
+
+    //
+    // The world calls the hook once per tick, right before updating the auction houses
+    //
+
+    std::vector<double> cycles;
+
+    for (uint32 cycle = 0; cycle < options.Cycles; ++cycle)
+    {
+        start = std::chrono::steady_clock::now();
+
+        sScriptMgr->OnBeforeAuctionHouseMgrUpdate();
+
+        cycles.push_back(elapsedMs(start));
+    }
+
+    std::sort(cycles.begin(), cycles.end());
+
+    if (!cycles.empty())
+    {
+        result.CycleP50Ms = cycles[(cycles.size() - 1) * 50 / 100];
+        result.CycleP95Ms = cycles[(cycles.size() - 1) * 95 / 100];
+        result.CycleMaxMs = cycles.back();
+    }
+
+    //
+    // The rates are computed on the time spent in the seller and buyer phases only
+    //
+
+    uint64 sellUs = 0;
+    uint64 buyUs  = 0;
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        AHBStats& stats = bot->GetStats();
+
+        for (uint32 ahid: gHouses)
+        {
+            result.Listings += stats.Get(ahid, AHB_COUNTER_SOLD);
+            result.Bids     += stats.Get(ahid, AHB_COUNTER_BIDS) + stats.Get(ahid, AHB_COUNTER_BUYOUTS);
+
+            sellUs          += stats.Get(ahid, AHB_PHASE_SELL).GetTotal();
+            buyUs           += stats.Get(ahid, AHB_PHASE_BUY).GetTotal();
+        }
+    }
+
+    result.ListingsPerSec = sellUs ? result.Listings * 1000000.0 / sellUs : 0.0;
+    result.BidsPerSec     = buyUs  ? result.Bids     * 1000000.0 / buyUs  : 0.0;
+    result.Commits        = CharacterDatabase.Commits - commits;
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+
+    //
+    // Defaults of the module for the benchmark: both the seller and the buyer at work, and the
+    // seller counting only the auctions of the bots
+    //
+
+    sConfigMgr->Values["AuctionHouseBot.Account"]                 = "1";
+    sConfigMgr->Values["AuctionHouseBot.EnableSeller"]            = "1";
+    sConfigMgr->Values["AuctionHouseBot.EnableBuyer"]             = "1";
+    sConfigMgr->Values["AuctionHouseBot.ConsiderOnlyBotAuctions"] = "1";
+
+    if (!parseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (options.Seed)
+    {
+        BenchRandom().seed(options.Seed);
+    }
+
+    createTemplates(options);
+
+    AHBot_WorldScript        worldScript;
+    AHBot_AuctionHouseScript auctionHouseScript;
+
+    fmt::print("{:>9} {:>10} {:>9} {:>9} {:>9} {:>9} {:>12} {:>7} {:>10} {:>8}\n",
+        "auctions", "load ms", "p50 ms", "p95 ms", "max ms", "listings", "listings/s", "bids", "bids/s", "commits");
+
+    bool first = true;
+
+    for (uint32 size: options.Sizes)
+    {
+        BenchResult result = runScenario(options, worldScript, size, first);
+
+        fmt::print("{:>9} {:>10.1f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9} {:>12.0f} {:>7} {:>10.0f} {:>8}\n",
+            result.Size, result.LoadMs, result.CycleP50Ms, result.CycleP95Ms, result.CycleMaxMs,
+            result.Listings, result.ListingsPerSec, result.Bids, result.BidsPerSec, result.Commits);
+
+        std::fflush(stdout);
+
+        first = false;
+    }
+
+    worldScript.OnShutdown();
+    clearHouses();
+
+    return 0;
+}
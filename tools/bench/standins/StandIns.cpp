@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+#include "StandIns.h"
+
+bool              gBenchLog = false;
+ObjectGuid const  ObjectGuid::Empty;
+BenchDatabase     CharacterDatabase;
+BenchDatabase     WorldDatabase;
+AuctionHouseStore sAuctionHouseStore;
+
+std::mt19937& BenchRandom()
+{
+    static thread_local std::mt19937 generator(std::random_device{}());
+    return generator;
+}
+
+// =============================================================================
+// Databases
+// =============================================================================
+
+static std::string trim(std::string const& text)
+{
+    size_t first = text.find_first_not_of(" \t\r\n");
+    size_t last  = text.find_last_not_of(" \t\r\n");
+
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+
+    return text.substr(first, last - first + 1);
+}
+
+static std::string lower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return text;
+}
+
+QueryResult BenchDatabase::Select(std::string const& sql)
+{
+    std::vector<std::vector<Field>> rows;
+    std::set<std::string>           seen;  // Rows already returned, for DISTINCT and UNION
+    uint32                          width = 0;
+
+    std::string text   = lower(sql);
+
+    //
+    // CHECKSUM TABLE table, ...: a hash of the rows, NULL for a missing table
+    //
+
+    if (text.compare(0, 15, "checksum table ") == 0)
+    {
+        std::stringstream tablesStream(text.substr(15));
+        std::string       table;
+
+        while (std::getline(tablesStream, table, ','))
+        {
+            table = trim(table);
+
+            std::map<std::string, std::vector<Row>>::const_iterator itr = Tables.find(table);
+            std::string                                             checksum;
+
+            if (itr != Tables.end())
+            {
+                uint64 hash = 0;
+
+                for (Row const& row: itr->second)
+                {
+                    for (Row::value_type const& column: row)
+                    {
+                        hash = hash * 31 + std::hash<std::string>()(column.first + '=' + column.second);
+                    }
+                }
+
+                checksum = std::to_string(hash & 0x7FFFFFFFFFFFFFFFULL);
+            }
+
+            rows.push_back({ Field(table), Field(checksum) });
+        }
+
+        return std::make_shared<ResultSet>(std::move(rows), 2);
+    }
+
+    bool        joined = text.find(" union ") != std::string::npos;
+    size_t      start  = 0;
+
+    while (start < text.size())
+    {
+        size_t      union_ = text.find(" union ", start);
+        std::string part   = trim(text.substr(start, union_ == std::string::npos ? std::string::npos : union_ - start));
+
+        start = union_ == std::string::npos ? text.size() : union_ + 7;
+
+        //
+        // SELECT [DISTINCT] columns FROM table [WHERE column = value]
+        //
+
+        if (part.compare(0, 7, "select ") != 0)
+        {
+            continue;
+        }
+
+        size_t from = part.find(" from ");
+
+        if (from == std::string::npos)
+        {
+            continue;
+        }
+
+        std::string columnsText = trim(part.substr(7, from - 7));
+        std::string rest        = trim(part.substr(from + 6));
+        bool        distinct    = joined;
+
+        if (columnsText.compare(0, 9, "distinct ") == 0)
+        {
+            columnsText = trim(columnsText.substr(9));
+            distinct    = true;
+        }
+
+        std::vector<std::string> columns;
+        std::stringstream        columnsStream(columnsText);
+        std::string              column;
+
+        while (std::getline(columnsStream, column, ','))
+        {
+            columns.push_back(trim(column));
+        }
+
+        size_t      where = rest.find(" where ");
+        std::string table = trim(rest.substr(0, where));
+        std::string whereColumn;
+        std::string whereValue;
+
+        if (where != std::string::npos)
+        {
+            std::string condition = rest.substr(where + 7);
+            size_t      equal     = condition.find('=');
+
+            whereColumn = trim(condition.substr(0, equal));
+            whereValue  = trim(condition.substr(equal + 1));
+        }
+
+        std::map<std::string, std::vector<Row>>::const_iterator itr = Tables.find(table);
+
+        if (itr == Tables.end())
+        {
+            continue;
+        }
+
+        width = columns.size();
+
+        for (Row const& row: itr->second)
+        {
+            if (!whereColumn.empty())
+            {
+                Row::const_iterator value = row.find(whereColumn);
+
+                if (value == row.end() || value->second != whereValue)
+                {
+                    continue;
+                }
+            }
+
+            std::vector<Field> fields;
+            std::string        key;
+
+            for (std::string const& name: columns)
+            {
+                Row::const_iterator value = row.find(name);
+
+                fields.push_back(Field(value != row.end() ? value->second : "0"));
+                key += fields.back().Get<std::string>() + '\x1f';
+            }
+
+            if (distinct && !seen.insert(key).second)
+            {
+                continue;
+            }
+
+            rows.push_back(std::move(fields));
+        }
+    }
+
+    if (rows.empty())
+    {
+        return QueryResult();
+    }
+
+    return std::make_shared<ResultSet>(std::move(rows), width);
+}
+
+// =============================================================================
+// Configuration and world
+// =============================================================================
+
+ConfigMgr* ConfigMgr::instance()
+{
+    static ConfigMgr instance;
+    return &instance;
+}
+
+World* World::instance()
+{
+    static World instance;
+    return &instance;
+}
+
+// =============================================================================
+// Items
+// =============================================================================
+
+Item* Item::CreateItem(uint32 item, uint32 count, Player const* /*player*/)
+{
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(item);
+
+    if (!proto)
+    {
+        return nullptr;
+    }
+
+    Item* newItem = new Item();
+
+    newItem->Guid     = ObjectGuid::Create<HighGuid::Item>(sObjectMgr->GenerateItemLowGuid());
+    newItem->Entry    = item;
+    newItem->Count    = count;
+    newItem->Template = proto;
+
+    return newItem;
+}
+
+uint32 Item::GenerateItemRandomPropertyId(uint32 itemId)
+{
+    ItemTemplate const* proto = sObjectMgr->GetItemTemplate(itemId);
+
+    return proto && proto->RandomProperty ? urand(1, 100) : 0;
+}
+
+// =============================================================================
+// Auction houses
+// =============================================================================
+
+AuctionHouseEntry const* AuctionHouseStore::LookupEntry(uint32 id) const
+{
+    static AuctionHouseEntry const entries[] =
+    {
+        { AUCTIONHOUSE_ALLIANCE, 55 , 15, 5  },
+        { AUCTIONHOUSE_HORDE   , 29 , 15, 5  },
+        { AUCTIONHOUSE_NEUTRAL , 120, 75, 15 }
+    };
+
+    for (AuctionHouseEntry const& entry: entries)
+    {
+        if (entry.houseId == id)
+        {
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void AuctionHouseObject::AddAuction(AuctionEntry* auction)
+{
+    AuctionsMap[auction->Id] = auction;
+    sScriptMgr->OnAuctionAdd(this, auction);
+}
+
+bool AuctionHouseObject::RemoveAuction(AuctionEntry* auction)
+{
+    bool wasInMap = AuctionsMap.erase(auction->Id) ? true : false;
+
+    sScriptMgr->OnAuctionRemove(this, auction);
+
+    delete auction;
+    return wasInMap;
+}
+
+void AuctionHouseObject::Update()
+{
+    //
+    // Same as the core: the lapsed auctions are either won by their bidder or expired
+    //
+
+    time_t now = time(nullptr);
+
+    std::vector<AuctionEntry*> lapsed;
+
+    for (AuctionEntryMap::value_type const& itr: AuctionsMap)
+    {
+        if (itr.second->expire_time <= now)
+        {
+            lapsed.push_back(itr.second);
+        }
+    }
+
+    for (AuctionEntry* auction: lapsed)
+    {
+        if (auction->bidder)
+        {
+            sScriptMgr->OnAuctionSuccessful(this, auction);
+        }
+        else
+        {
+            sScriptMgr->OnAuctionExpire(this, auction);
+        }
+
+        sAuctionMgr->RemoveAItem(auction->item_guid, true);
+        RemoveAuction(auction);
+    }
+}
+
+AuctionHouseMgr* AuctionHouseMgr::instance()
+{
+    static AuctionHouseMgr instance;
+    return &instance;
+}
+
+AuctionHouseObject* AuctionHouseMgr::GetAuctionsMap(uint32 factionTemplateId)
+{
+    switch (factionTemplateId)
+    {
+    case 55:
+        return &Alliance;
+
+    case 29:
+        return &Horde;
+
+    default:
+        return &Neutral;
+    }
+}
+
+AuctionHouseEntry const* AuctionHouseMgr::GetAuctionHouseEntry(uint32 factionTemplateId)
+{
+    switch (factionTemplateId)
+    {
+    case 55:
+        return sAuctionHouseStore.LookupEntry(AUCTIONHOUSE_ALLIANCE);
+
+    case 29:
+        return sAuctionHouseStore.LookupEntry(AUCTIONHOUSE_HORDE);
+
+    default:
+        return sAuctionHouseStore.LookupEntry(AUCTIONHOUSE_NEUTRAL);
+    }
+}
+
+Item* AuctionHouseMgr::GetAItem(ObjectGuid itemGuid)
+{
+    std::map<ObjectGuid, Item*>::const_iterator itr = Items.find(itemGuid);
+    return itr != Items.end() ? itr->second : nullptr;
+}
+
+bool AuctionHouseMgr::RemoveAItem(ObjectGuid itemGuid, bool deleteItem)
+{
+    std::map<ObjectGuid, Item*>::iterator itr = Items.find(itemGuid);
+
+    if (itr == Items.end())
+    {
+        return false;
+    }
+
+    if (deleteItem)
+    {
+        delete itr->second;
+    }
+
+    Items.erase(itr);
+    return true;
+}
+
+// =============================================================================
+// Object manager
+// =============================================================================
+
+ObjectMgr* ObjectMgr::instance()
+{
+    static ObjectMgr instance;
+    return &instance;
+}
+
+// =============================================================================
+// Scripts
+// =============================================================================
+
+AuctionHouseScript::AuctionHouseScript(char const* name) : ScriptObject(name)
+{
+    sScriptMgr->AuctionHouseScripts.push_back(this);
+}
+
+ScriptMgr* ScriptMgr::instance()
+{
+    static ScriptMgr instance;
+    return &instance;
+}
+
+void ScriptMgr::OnAuctionAdd(AuctionHouseObject* ah, AuctionEntry* auction)
+{
+    for (AuctionHouseScript* script: AuctionHouseScripts)
+    {
+        script->OnAuctionAdd(ah, auction);
+    }
+}
+
+void ScriptMgr::OnAuctionRemove(AuctionHouseObject* ah, AuctionEntry* auction)
+{
+    for (AuctionHouseScript* script: AuctionHouseScripts)
+    {
+        script->OnAuctionRemove(ah, auction);
+    }
+}
+
+void ScriptMgr::OnAuctionSuccessful(AuctionHouseObject* ah, AuctionEntry* auction)
+{
+    for (AuctionHouseScript* script: AuctionHouseScripts)
+    {
+        script->OnAuctionSuccessful(ah, auction);
+    }
+}
+
+void ScriptMgr::OnAuctionExpire(AuctionHouseObject* ah, AuctionEntry* auction)
+{
+    for (AuctionHouseScript* script: AuctionHouseScripts)
+    {
+        script->OnAuctionExpire(ah, auction);
+    }
+}
+
+void ScriptMgr::OnBeforeAuctionHouseMgrUpdate()
+{
+    for (AuctionHouseScript* script: AuctionHouseScripts)
+    {
+        script->OnBeforeAuctionHouseMgrUpdate();
+    }
+}
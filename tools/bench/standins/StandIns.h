@@ -0,0 +1,727 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AHBOT_BENCH_STAND_INS_H
+#define AHBOT_BENCH_STAND_INS_H
+
+//
+// In-memory stand-ins for the parts of AzerothCore used by the module: the item templates,
+// the auction houses, the databases, the configuration and the scripts hooks.
+// They keep the signatures of the core, so that the sources of the module compile unchanged.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+typedef std::int64_t  int64;
+typedef std::int32_t  int32;
+typedef std::int16_t  int16;
+typedef std::int8_t   int8;
+typedef std::uint64_t uint64;
+typedef std::uint32_t uint32;
+typedef std::uint16_t uint16;
+typedef std::uint8_t  uint8;
+
+constexpr time_t MINUTE = 60;
+constexpr time_t HOUR   = 60 * MINUTE;
+constexpr time_t DAY    = 24 * HOUR;
+
+// =============================================================================
+// Random numbers and timers
+// =============================================================================
+
+std::mt19937& BenchRandom();
+
+inline uint32 urand(uint32 min, uint32 max)
+{
+    if (max < min)
+    {
+        std::swap(min, max);
+    }
+
+    return std::uniform_int_distribution<uint32>(min, max)(BenchRandom());
+}
+
+inline double rand_norm()
+{
+    return std::uniform_real_distribution<double>(0.0, 1.0)(BenchRandom());
+}
+
+inline uint32 getMSTime()
+{
+    return uint32(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline uint32 getMSTimeDiff(uint32 oldMSTime, uint32 newMSTime)
+{
+    return newMSTime - oldMSTime;
+}
+
+namespace GameTime
+{
+    inline std::chrono::seconds GetGameTime()
+    {
+        return std::chrono::seconds(time(nullptr));
+    }
+}
+
+namespace Acore
+{
+    template<typename... Args>
+    std::string StringFormat(std::string_view fmt, Args&&... args)
+    {
+        return fmt::format(fmt::runtime(fmt), std::forward<Args>(args)...);
+    }
+}
+
+// =============================================================================
+// Logging, silent unless asked for
+// =============================================================================
+
+extern bool gBenchLog;
+
+#define LOG_INFO(filterType, ...)  do { if (gBenchLog) { fmt::print("[INFO ] {}\n", fmt::format(__VA_ARGS__)); } } while (0)
+#define LOG_ERROR(filterType, ...) do { if (gBenchLog) { fmt::print("[ERROR] {}\n", fmt::format(__VA_ARGS__)); } } while (0)
+#define LOG_DEBUG(filterType, ...) do { } while (0)
+
+enum AccountTypes   { SEC_PLAYER = 0, SEC_MODERATOR = 1, SEC_GAMEMASTER = 2, SEC_ADMINISTRATOR = 3 };
+enum LocaleConstant { LOCALE_enUS = 0 };
+
+// =============================================================================
+// Guids
+// =============================================================================
+
+enum class HighGuid { Player, Item };
+
+class ObjectGuid
+{
+private:
+    uint64 _guid;
+
+public:
+    typedef uint32 LowType;
+
+    ObjectGuid() : _guid(0) { }
+    explicit ObjectGuid(uint64 raw) : _guid(raw) { }
+
+    template<HighGuid high>
+    static ObjectGuid Create(LowType counter) { return ObjectGuid((uint64(high) << 48) | counter); }
+
+    LowType     GetCounter () const { return LowType(_guid & 0xFFFFFFFF); }
+    uint64      GetRawValue() const { return _guid; }
+    std::string ToString   () const { return std::to_string(_guid); }
+
+    explicit operator bool() const { return _guid != 0; }
+
+    bool operator! () const                  { return _guid == 0; }
+    bool operator==(ObjectGuid const& o) const { return _guid == o._guid; }
+    bool operator!=(ObjectGuid const& o) const { return _guid != o._guid; }
+    bool operator< (ObjectGuid const& o) const { return _guid <  o._guid; }
+
+    static ObjectGuid const Empty;
+};
+
+// =============================================================================
+// Databases: the tables are rows of named text values, the queries understand
+// "SELECT [DISTINCT] columns FROM table [WHERE column = value]" joined by UNION.
+// The statements which write are only counted.
+// =============================================================================
+
+class Field
+{
+private:
+    std::string _value;
+
+public:
+    Field() { }
+    explicit Field(std::string value) : _value(std::move(value)) { }
+
+    template<typename T>
+    T Get() const
+    {
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            return _value;
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            return std::strtoll(_value.c_str(), nullptr, 10) != 0;
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return T(std::strtod(_value.c_str(), nullptr));
+        }
+        else
+        {
+            return T(std::strtoll(_value.c_str(), nullptr, 10));
+        }
+    }
+};
+
+class ResultSet
+{
+private:
+    std::vector<std::vector<Field>> _rows;
+    uint32                          _fields;
+    size_t                          _cursor;
+
+public:
+    ResultSet(std::vector<std::vector<Field>>&& rows, uint32 fields) : _rows(std::move(rows)), _fields(fields), _cursor(0) { }
+
+    Field* Fetch        ()       { return _rows[_cursor].data(); }
+    bool   NextRow      ()       { return ++_cursor < _rows.size(); }
+    uint64 GetRowCount  () const { return _rows.size(); }
+    uint32 GetFieldCount() const { return _fields; }
+};
+
+typedef std::shared_ptr<ResultSet> QueryResult;
+
+enum CharacterDatabaseStatements
+{
+    CHAR_UPD_AUCTION_BID,
+    CHAR_UPD_AUCTION_EXPIRATION,
+    CHAR_INS_AUCTION,
+    CHAR_DEL_AUCTION,
+
+    MAX_CHARACTERDATABASE_STATEMENTS
+};
+
+class PreparedStatementBase
+{
+public:
+    explicit PreparedStatementBase(uint32 index) : Index(index) { }
+
+    template<typename T>
+    void SetData(uint8 /*index*/, T const& /*value*/) { }
+
+    uint32 Index;
+};
+
+typedef PreparedStatementBase CharacterDatabasePreparedStatement;
+
+class TransactionBase
+{
+public:
+    size_t Size = 0;
+
+    template<typename... Args>
+    void Append(std::string_view /*sql*/, Args&&... /*args*/) { ++Size; }
+    void Append(CharacterDatabasePreparedStatement* stmt)     { ++Size; delete stmt; }
+
+    size_t GetSize() const { return Size; }
+};
+
+typedef std::shared_ptr<TransactionBase> CharacterDatabaseTransaction;
+typedef std::shared_ptr<TransactionBase> WorldDatabaseTransaction;
+
+class BenchDatabase
+{
+public:
+    typedef std::map<std::string, std::string> Row;
+
+    std::map<std::string, std::vector<Row>> Tables;
+
+    uint64 Queries    = 0;
+    uint64 Executes   = 0;
+    uint64 Commits    = 0;
+    uint64 Statements = 0;
+
+    QueryResult Select(std::string const& sql);
+
+    template<typename... Args>
+    QueryResult Query(std::string_view sql, Args&&... args)
+    {
+        ++Queries;
+        return Select(fmt::format(fmt::runtime(sql), std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    void Execute(std::string_view /*sql*/, Args&&... /*args*/) { ++Executes; }
+    void Execute(CharacterDatabasePreparedStatement* stmt)     { ++Executes; delete stmt; }
+
+    std::shared_ptr<TransactionBase> BeginTransaction() { return std::make_shared<TransactionBase>(); }
+
+    void CommitTransaction(std::shared_ptr<TransactionBase> trans)
+    {
+        ++Commits;
+        Statements += trans->Size;
+    }
+
+    CharacterDatabasePreparedStatement* GetPreparedStatement(uint32 index) { return new CharacterDatabasePreparedStatement(index); }
+};
+
+extern BenchDatabase CharacterDatabase;
+extern BenchDatabase WorldDatabase;
+
+// =============================================================================
+// Configuration and world
+// =============================================================================
+
+class ConfigMgr
+{
+public:
+    std::map<std::string, std::string> Values;
+
+    template<typename T>
+    T GetOption(std::string const& name, T const& def) const
+    {
+        std::map<std::string, std::string>::const_iterator itr = Values.find(name);
+
+        if (itr == Values.end())
+        {
+            return def;
+        }
+
+        return Field(itr->second).Get<T>();
+    }
+
+    static ConfigMgr* instance();
+};
+
+#define sConfigMgr ConfigMgr::instance()
+
+enum WorldIntConfigs  { CONFIG_EXPANSION };
+enum WorldBoolConfigs { CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION };
+
+class World
+{
+public:
+    bool TwoSide = false;
+
+    uint32 getIntConfig (WorldIntConfigs ) const { return 2; }
+    bool   getBoolConfig(WorldBoolConfigs) const { return TwoSide; }
+
+    static World* instance();
+};
+
+#define sWorld World::instance()
+
+// =============================================================================
+// Items
+// =============================================================================
+
+enum ItemQualities
+{
+    ITEM_QUALITY_POOR = 0,
+    ITEM_QUALITY_NORMAL,
+    ITEM_QUALITY_UNCOMMON,
+    ITEM_QUALITY_RARE,
+    ITEM_QUALITY_EPIC,
+    ITEM_QUALITY_LEGENDARY,
+    ITEM_QUALITY_ARTIFACT,
+    ITEM_QUALITY_HEIRLOOM,
+
+    MAX_ITEM_QUALITY
+};
+
+enum ItemClass
+{
+    ITEM_CLASS_CONSUMABLE = 0,
+    ITEM_CLASS_CONTAINER,
+    ITEM_CLASS_WEAPON,
+    ITEM_CLASS_GEM,
+    ITEM_CLASS_ARMOR,
+    ITEM_CLASS_REAGENT,
+    ITEM_CLASS_PROJECTILE,
+    ITEM_CLASS_TRADE_GOODS,
+    ITEM_CLASS_GENERIC,
+    ITEM_CLASS_RECIPE,
+    ITEM_CLASS_MONEY,
+    ITEM_CLASS_QUIVER,
+    ITEM_CLASS_QUEST,
+    ITEM_CLASS_KEY,
+    ITEM_CLASS_PERMANENT,
+    ITEM_CLASS_MISC,
+    ITEM_CLASS_GLYPH,
+
+    MAX_ITEM_CLASS
+};
+
+enum ItemBondingType
+{
+    NO_BIND = 0,
+    BIND_WHEN_PICKED_UP,
+    BIND_WHEN_EQUIPPED,
+    BIND_WHEN_USE,
+    BIND_QUEST_ITEM,
+    BIND_QUEST_ITEM1,
+
+    MAX_BIND_TYPE
+};
+
+struct ItemTemplate
+{
+    uint32 ItemId            = 0;
+    uint32 Class             = 0;
+    uint32 SubClass          = 0;
+    uint32 Quality           = 0;
+    uint32 Flags             = 0;
+    int32  BuyPrice          = 0;
+    uint32 SellPrice         = 0;
+    int32  AllowableClass    = -1;
+    uint32 ItemLevel         = 0;
+    uint32 RequiredLevel     = 0;
+    uint32 RequiredSkillRank = 0;
+    int32  Stackable         = 1;
+    uint32 Bonding           = 0;
+    uint32 MinMoneyLoot      = 0;
+    uint32 Duration          = 0;
+    uint32 RandomProperty    = 0;
+    uint32 RandomSuffix      = 0;
+    uint32 AmmoType          = 0;
+
+    bool   IsConjuredConsumable() const { return Class == ITEM_CLASS_CONSUMABLE && (Flags & 2); }
+    uint32 GetMaxStackSize     () const { return (Stackable == 2147483647 || Stackable <= 0) ? uint32(0x7FFFFFFF - 1) : uint32(Stackable); }
+};
+
+typedef std::unordered_map<uint32, ItemTemplate> ItemTemplateContainer;
+
+class Player;
+
+class Item
+{
+public:
+    ObjectGuid          Guid;
+    uint32              Entry    = 0;
+    uint32              Count    = 1;
+    ItemTemplate const* Template = nullptr;
+
+    static Item*  CreateItem(uint32 item, uint32 count, Player const* player = nullptr);
+    static uint32 GenerateItemRandomPropertyId(uint32 itemId);
+
+    ObjectGuid          GetGUID         () const { return Guid; }
+    uint32              GetEntry        () const { return Entry; }
+    uint32              GetCount        () const { return Count; }
+    uint32              GetMaxStackCount() const { return Template->GetMaxStackSize(); }
+    ItemTemplate const* GetTemplate     () const { return Template; }
+
+    void SetCount               (uint32 value) { Count = value; }
+    void SetItemRandomProperties(int32 /*id*/) { }
+    void AddToUpdateQueueOf     (Player*)      { }
+    void RemoveFromUpdateQueueOf(Player*)      { }
+
+    void SaveToDB(CharacterDatabaseTransaction trans) { trans->Append("item"); }
+};
+
+// =============================================================================
+// Auction houses
+// =============================================================================
+
+enum AuctionHouses
+{
+    AUCTIONHOUSE_ALLIANCE = 2,
+    AUCTIONHOUSE_HORDE    = 6,
+    AUCTIONHOUSE_NEUTRAL  = 7
+};
+
+struct AuctionHouseEntry
+{
+    uint32 houseId;
+    uint32 faction;
+    uint32 depositPercent;
+    uint32 cutPercent;
+};
+
+class AuctionHouseStore
+{
+public:
+    AuctionHouseEntry const* LookupEntry(uint32 id) const;
+};
+
+extern AuctionHouseStore sAuctionHouseStore;
+
+struct AuctionEntry
+{
+    uint32                   Id                = 0;
+    uint8                    houseId           = 0;
+    ObjectGuid               item_guid;
+    uint32                   item_template     = 0;
+    uint32                   itemCount         = 0;
+    ObjectGuid               owner;
+    uint32                   startbid          = 0;
+    uint32                   bid               = 0;
+    uint32                   buyout            = 0;
+    time_t                   expire_time       = 0;
+    ObjectGuid               bidder;
+    uint32                   deposit           = 0;
+    AuctionHouseEntry const* auctionHouseEntry = nullptr;
+
+    uint8  GetHouseId() const { return houseId; }
+
+    uint32 GetAuctionOutBid() const
+    {
+        uint32 outbid = (bid / 100) * 5;
+        return outbid ? outbid : 1;
+    }
+
+    void DeleteFromDB(CharacterDatabaseTransaction trans) const { trans->Append("delete"); }
+    void SaveToDB    (CharacterDatabaseTransaction trans) const { trans->Append("save"); }
+};
+
+class AuctionHouseObject
+{
+public:
+    typedef std::map<uint32, AuctionEntry*> AuctionEntryMap;
+
+    AuctionEntryMap AuctionsMap;
+
+    uint32                    Getcount        () const { return uint32(AuctionsMap.size()); }
+    AuctionEntryMap::iterator GetAuctionsBegin()       { return AuctionsMap.begin(); }
+    AuctionEntryMap::iterator GetAuctionsEnd  ()       { return AuctionsMap.end(); }
+
+    AuctionEntry* GetAuction(uint32 id) const
+    {
+        AuctionEntryMap::const_iterator itr = AuctionsMap.find(id);
+        return itr != AuctionsMap.end() ? itr->second : nullptr;
+    }
+
+    void AddAuction   (AuctionEntry* auction);
+    bool RemoveAuction(AuctionEntry* auction);
+    void Update       ();
+};
+
+class AuctionHouseMgr
+{
+public:
+    AuctionHouseObject           Alliance;
+    AuctionHouseObject           Horde;
+    AuctionHouseObject           Neutral;
+    std::map<ObjectGuid, Item*>  Items;
+
+    static AuctionHouseMgr* instance();
+
+    AuctionHouseObject*      GetAuctionsMap      (uint32 factionTemplateId);
+    AuctionHouseEntry const* GetAuctionHouseEntry(uint32 factionTemplateId);
+
+    Item* GetAItem   (ObjectGuid itemGuid);
+    void  AddAItem   (Item* item) { Items[item->GetGUID()] = item; }
+    bool  RemoveAItem(ObjectGuid itemGuid, bool deleteItem = false);
+
+    uint32 GetAuctionDeposit(AuctionHouseEntry const* /*entry*/, uint32 time, Item* /*pItem*/, uint32 count) { return time / 3600 * count; }
+
+    void SendAuctionWonMail       (AuctionEntry*, CharacterDatabaseTransaction trans, bool = true, bool = false)                  { trans->Append("won"); }
+    void SendAuctionSuccessfulMail(AuctionEntry*, CharacterDatabaseTransaction trans, bool = true, bool = false)                  { trans->Append("successful"); }
+    void SendAuctionOutbiddedMail (AuctionEntry*, uint32, Player*, CharacterDatabaseTransaction trans, bool = true, bool = false) { trans->Append("outbidded"); }
+
+    void Update() { }
+};
+
+#define sAuctionMgr AuctionHouseMgr::instance()
+
+// =============================================================================
+// Object manager
+// =============================================================================
+
+class ObjectMgr
+{
+public:
+    ItemTemplateContainer Templates;
+    uint32                AuctionId = 0;
+    uint32                ItemGuid  = 0;
+
+    static ObjectMgr* instance();
+
+    ItemTemplate const* GetItemTemplate(uint32 entry)
+    {
+        ItemTemplateContainer::const_iterator itr = Templates.find(entry);
+        return itr != Templates.end() ? &itr->second : nullptr;
+    }
+
+    ItemTemplateContainer const* GetItemTemplateStore() const { return &Templates; }
+
+    uint32 GenerateAuctionID  () { return ++AuctionId; }
+    uint32 GenerateItemLowGuid() { return ++ItemGuid; }
+};
+
+#define sObjectMgr ObjectMgr::instance()
+
+// =============================================================================
+// Players and sessions
+// =============================================================================
+
+class WorldSession;
+
+class Player
+{
+private:
+    WorldSession* _session;
+    ObjectGuid    _guid;
+
+public:
+    explicit Player(WorldSession* session) : _session(session) { }
+    virtual ~Player() { }
+
+    void          Initialize(ObjectGuid::LowType guid) { _guid = ObjectGuid::Create<HighGuid::Player>(guid); }
+    ObjectGuid    GetGUID   () const                   { return _guid; }
+    WorldSession* GetSession() const                   { return _session; }
+};
+
+class WorldSession
+{
+private:
+    uint32      _id;
+    std::string _name;
+    Player*     _player;
+
+public:
+    WorldSession(uint32 id, std::string&& name, std::shared_ptr<void> /*sock*/, AccountTypes /*sec*/, uint8 /*expansion*/, time_t /*mute_time*/, LocaleConstant /*locale*/, uint32 /*recruiter*/, bool /*isARecruiter*/, bool /*skipQueue*/, uint32 /*TotalTime*/)
+        : _id(id), _name(std::move(name)), _player(nullptr) { }
+    virtual ~WorldSession() { }
+
+    Player* GetPlayer() const        { return _player; }
+    void    SetPlayer(Player* player) { _player = player; }
+
+    void SendAuctionBidderNotification(uint32, uint32, ObjectGuid, uint32, uint32, uint32) { }
+};
+
+namespace ObjectAccessor
+{
+    inline void AddObject   (Player*) { }
+    inline void RemoveObject(Player*) { }
+}
+
+// =============================================================================
+// Mails
+// =============================================================================
+
+enum MailMessageType { MAIL_NORMAL = 0, MAIL_AUCTION = 2 };
+enum MailCheckMask   { MAIL_CHECK_MASK_NONE = 0 };
+
+class MailDraft { };
+
+class MailReceiver
+{
+public:
+    ObjectGuid::LowType Low = 0;
+
+    ObjectGuid::LowType GetPlayerGUIDLow() const { return Low; }
+};
+
+class MailSender
+{
+public:
+    MailMessageType Type = MAIL_NORMAL;
+
+    MailMessageType GetMailMessageType() const { return Type; }
+};
+
+// =============================================================================
+// Scripts
+// =============================================================================
+
+class ScriptObject
+{
+private:
+    std::string _name;
+
+public:
+    explicit ScriptObject(char const* name) : _name(name) { }
+    virtual ~ScriptObject() { }
+};
+
+class WorldScript : public ScriptObject
+{
+public:
+    explicit WorldScript(char const* name) : ScriptObject(name) { }
+
+    virtual void OnBeforeConfigLoad(bool /*reload*/) { }
+    virtual void OnAfterConfigLoad (bool /*reload*/) { }
+    virtual void OnStartup         () { }
+    virtual void OnShutdown        () { }
+    virtual void OnUpdate          (uint32 /*diff*/) { }
+};
+
+class AuctionHouseScript : public ScriptObject
+{
+public:
+    explicit AuctionHouseScript(char const* name);
+
+    virtual void OnAuctionAdd       (AuctionHouseObject*, AuctionEntry*) { }
+    virtual void OnAuctionRemove    (AuctionHouseObject*, AuctionEntry*) { }
+    virtual void OnAuctionSuccessful(AuctionHouseObject*, AuctionEntry*) { }
+    virtual void OnAuctionExpire    (AuctionHouseObject*, AuctionEntry*) { }
+
+    virtual void OnBeforeAuctionHouseMgrSendAuctionWonMail        (AuctionHouseMgr*, AuctionEntry*, Player*, uint32&, bool&, bool&) { }
+    virtual void OnBeforeAuctionHouseMgrSendAuctionSalePendingMail(AuctionHouseMgr*, AuctionEntry*, Player*, uint32&, bool&) { }
+    virtual void OnBeforeAuctionHouseMgrSendAuctionSuccessfulMail (AuctionHouseMgr*, AuctionEntry*, Player*, uint32&, uint32&, bool&, bool&, bool&) { }
+    virtual void OnBeforeAuctionHouseMgrSendAuctionExpiredMail    (AuctionHouseMgr*, AuctionEntry*, Player*, uint32&, bool&, bool&) { }
+    virtual void OnBeforeAuctionHouseMgrSendAuctionOutbiddedMail  (AuctionHouseMgr*, AuctionEntry*, Player*, uint32&, Player*, uint32&, bool&, bool&) { }
+    virtual void OnBeforeAuctionHouseMgrUpdate                    () { }
+};
+
+class MailScript : public ScriptObject
+{
+public:
+    explicit MailScript(char const* name) : ScriptObject(name) { }
+
+    virtual void OnBeforeMailDraftSendMailTo(MailDraft*, MailReceiver const&, MailSender const&, MailCheckMask&, uint32&, uint32&, bool&, bool&) { }
+};
+
+namespace Acore::ChatCommands
+{
+    enum class Console : uint8 { No, Yes };
+
+    struct ChatCommandBuilder
+    {
+        char const* Name;
+        uint32      Security;
+        Console     Con;
+
+        template<typename F>
+        ChatCommandBuilder(char const* name, F, uint32 sec, Console console) : Name(name), Security(sec), Con(console) { }
+    };
+}
+
+typedef Acore::ChatCommands::ChatCommandBuilder ChatCommand;
+
+class CommandScript : public ScriptObject
+{
+public:
+    explicit CommandScript(char const* name) : ScriptObject(name) { }
+
+    virtual std::vector<ChatCommand> GetCommands() const = 0;
+};
+
+class ChatHandler
+{
+public:
+    std::vector<std::string> Messages;
+
+    template<typename... Args>
+    void PSendSysMessage(std::string_view str, Args&&... args) { Messages.push_back(fmt::format(fmt::runtime(str), std::forward<Args>(args)...)); }
+    void SendSysMessage (std::string_view str)                 { Messages.emplace_back(str); }
+};
+
+class ScriptMgr
+{
+public:
+    std::vector<AuctionHouseScript*> AuctionHouseScripts;
+
+    static ScriptMgr* instance();
+
+    void OnAuctionAdd       (AuctionHouseObject* ah, AuctionEntry* auction);
+    void OnAuctionRemove    (AuctionHouseObject* ah, AuctionEntry* auction);
+    void OnAuctionSuccessful(AuctionHouseObject* ah, AuctionEntry* auction);
+    void OnAuctionExpire    (AuctionHouseObject* ah, AuctionEntry* auction);
+
+    void OnBeforeAuctionHouseMgrUpdate();
+};
+
+#define sScriptMgr ScriptMgr::instance()
+
+#endif // AHBOT_BENCH_STAND_INS_H
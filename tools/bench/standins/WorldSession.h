@@ -0,0 +1,10 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AHBOT_BENCH_WORLD_SESSION_H
+#define AHBOT_BENCH_WORLD_SESSION_H
+
+#include "StandIns.h"
+
+#endif // AHBOT_BENCH_WORLD_SESSION_H